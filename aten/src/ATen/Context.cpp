@@ -55,6 +55,22 @@ void Context::setBenchmarkCuDNN(bool b) {
   benchmark_cudnn = b;
 }
 
+bool Context::sparseConvMkldnn() const {
+  return sparse_conv_mkldnn;
+}
+
+void Context::setSparseConvMkldnn(bool b) {
+  sparse_conv_mkldnn = b;
+}
+
+double Context::sparseConvMkldnnThreshold() const {
+  return sparse_conv_mkldnn_threshold;
+}
+
+void Context::setSparseConvMkldnnThreshold(double t) {
+  sparse_conv_mkldnn_threshold = t;
+}
+
 bool Context::hasMKL() const {
 #if AT_MKL_ENABLED()
   return true;
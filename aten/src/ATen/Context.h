@@ -100,6 +100,14 @@ class CAFFE2_API Context {
   void setBenchmarkCuDNN(bool);
   bool deterministicCuDNN() const;
   void setDeterministicCuDNN(bool);
+  // Whether convolutions on inputs with mostly all-zero rows dispatch to
+  // the sparse MKL-DNN convolution (requires the sparse jit_avx512_common
+  // convolution in the linked MKL-DNN). The sparse path is taken when the
+  // estimated fraction of non-zero input rows is below the threshold.
+  bool sparseConvMkldnn() const;
+  void setSparseConvMkldnn(bool);
+  double sparseConvMkldnnThreshold() const;
+  void setSparseConvMkldnnThreshold(double);
 private:
   void initCUDAIfNeeded(DeviceType p) {
     if (p == DeviceType::CUDA) {
@@ -116,6 +124,8 @@ private:
   bool enabled_cudnn = true;
   bool deterministic_cudnn = false;
   bool benchmark_cudnn = false;
+  bool sparse_conv_mkldnn = false;
+  double sparse_conv_mkldnn_threshold = 0.5;
   std::unique_ptr<THCState, void(*)(THCState*)> thc_state;
   std::unique_ptr<THHState, void(*)(THHState*)> thh_state;
 };
@@ -0,0 +1,44 @@
+#include <ATen/SparseConvStats.h>
+
+namespace at {
+
+SparseConvStats& SparseConvStats::operator+=(const SparseConvStats& other) {
+  calls += other.calls;
+  rows += other.rows;
+  rows_skipped += other.rows_skipped;
+  scan_ns += other.scan_ns;
+  kernel_ns += other.kernel_ns;
+  thread_max_ns += other.thread_max_ns;
+  thread_avg_ns += other.thread_avg_ns;
+  return *this;
+}
+
+std::vector<std::pair<std::string, double>> SparseConvStats::counters() const {
+  return {
+      {"sparse_conv_calls", static_cast<double>(calls)},
+      {"rows_visited", static_cast<double>(rows)},
+      {"rows_skipped", static_cast<double>(rows_skipped)},
+      {"scan_us", scan_ns / 1000.0},
+      {"kernel_us", kernel_ns / 1000.0},
+      {"thread_imbalance",
+       thread_avg_ns > 0
+           ? static_cast<double>(thread_max_ns) / thread_avg_ns
+           : 1.0},
+  };
+}
+
+namespace {
+thread_local SparseConvStats thread_stats;
+} // namespace
+
+SparseConvStats& sparse_conv_stats() {
+  return thread_stats;
+}
+
+SparseConvStats take_sparse_conv_stats() {
+  SparseConvStats stats = thread_stats;
+  thread_stats = SparseConvStats();
+  return stats;
+}
+
+} // namespace at
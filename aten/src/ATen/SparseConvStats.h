@@ -0,0 +1,38 @@
+#pragma once
+
+#include <c10/macros/Macros.h>
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace at {
+
+// Counters of the sparse MKL-DNN convolutions executed on the current thread.
+// Output rows are counted per (batch, group, output row, output column block)
+// tile, as the kernel visits them; times are in nanoseconds. The thread times
+// are summed over the calls, so thread_max_ns / thread_avg_ns is the average
+// load imbalance between the threads of a call.
+struct CAFFE2_API SparseConvStats {
+  int64_t calls = 0;
+  int64_t rows = 0;
+  int64_t rows_skipped = 0;
+  int64_t scan_ns = 0;
+  int64_t kernel_ns = 0;
+  int64_t thread_max_ns = 0;
+  int64_t thread_avg_ns = 0;
+
+  SparseConvStats& operator+=(const SparseConvStats& other);
+
+  // (name, value) pairs, as reported by the autograd profiler
+  std::vector<std::pair<std::string, double>> counters() const;
+};
+
+// The counters accumulated on the current thread
+CAFFE2_API SparseConvStats& sparse_conv_stats();
+
+// Returns the counters accumulated on the current thread and resets them
+CAFFE2_API SparseConvStats take_sparse_conv_stats();
+
+} // namespace at
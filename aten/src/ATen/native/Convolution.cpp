@@ -6,6 +6,9 @@
 #if AT_NNPACK_ENABLED()
 #include "nnpack.h"
 #endif
+#if AT_MKLDNN_ENABLED()
+#include <ATen/native/mkldnn/MKLDNNCommon.h>
+#endif
 
 static const int MIOPEN_DIM_MAX = 4;
 
@@ -21,12 +24,15 @@ struct ConvParams {
   bool benchmark;
   bool deterministic;
   bool cudnn_enabled;
+  bool sparse_enabled;
+  double sparse_threshold;
 
   bool is_strided() const;
   bool is_dilated() const;
   bool is_padded() const;
   bool is_output_padding_neg() const;
   bool is_output_padding_big() const;
+  bool is_output_padding_big_for_mkldnn() const;
   bool is_padding_neg() const;
   bool is_stride_neg() const;
   void view1d_as_2d();
@@ -34,6 +40,7 @@ struct ConvParams {
   bool use_cudnn_depthwise(const at::Tensor& input, const at::Tensor& weight) const;
   bool use_miopen(const at::Tensor& input) const;
   bool use_mkldnn(const at::Tensor& input) const;
+  bool use_mkldnn_sparse(const at::Tensor& input) const;
   bool use_nnpack(const at::Tensor& input) const;
   bool is_depthwise(const at::Tensor& input, const at::Tensor& weight) const;
 };
@@ -49,6 +56,8 @@ std::ostream& operator<<(std::ostream & out, const ConvParams& params) {
       << "  benchmark = " << params.benchmark
       << "  deterministic = " << params.deterministic
       << "  cudnn_enabled = " << params.cudnn_enabled
+      << "  sparse_enabled = " << params.sparse_enabled
+      << "  sparse_threshold = " << params.sparse_threshold
       << "}";
   return out;
 }
@@ -93,6 +102,18 @@ auto ConvParams::is_output_padding_big() const -> bool {
   return is_big;
 }
 
+// MKL-DNN only needs the output padding to fit in the stride, e.g. stride 2
+// with output_padding 1 and no dilation: the transposed convolution runs as a
+// backward-data convolution with symmetric padding, whose forward output has
+// in + output_padding / stride rows
+auto ConvParams::is_output_padding_big_for_mkldnn() const -> bool {
+  bool is_big = false;
+  for (size_t i = 0; i < output_padding.size(); i++) {
+    is_big |= (output_padding[i] >= stride[i]);
+  }
+  return is_big;
+}
+
 auto ConvParams::is_padding_neg() const -> bool {
   bool is_non_neg = false;
   for (int p : padding) {
@@ -152,12 +173,42 @@ auto ConvParams::use_mkldnn(const at::Tensor& input) const -> bool {
   return (input.is_mkldnn()) || // input is mkldnn Tensor
     (input.type().backend() == at::Backend::CPU &&
      input.scalar_type() == kFloat && // only on CPU Float Tensors
-     !is_dilated() && // doesn't support dilation
-     !transposed && // or transposed tensors
+     !is_output_padding_big_for_mkldnn() && // output padding must fit in the stride
      input.ndimension() == 4); // must be in NCHW format
 #endif
   return false;
 }
+
+// Fraction of the input rows that are not all zero, estimated from at most
+// kSparseSampledRows evenly spaced rows of every image so that the cost on
+// dense inputs stays small and independent of the image height.
+static constexpr int64_t kSparseSampledRows = 32;
+
+static double sampled_row_density(const at::Tensor& input) {
+  const int64_t height = input.size(2);
+  if (input.numel() == 0 || height == 0) {
+    return 1.;
+  }
+  // rounded up, so that no more than kSparseSampledRows rows are taken
+  const int64_t step = (height + kSparseSampledRows - 1) / kSparseSampledRows;
+  auto rows = input.slice(2, 0, height, step).ne(0).any(3).any(1);
+  return rows.sum().item<double>() / rows.numel();
+}
+
+// Sparse row skipping only pays off when enough rows are empty; the
+// density is only estimated when everything else allows the sparse path.
+auto ConvParams::use_mkldnn_sparse(const at::Tensor& input) const -> bool {
+#if AT_MKLDNN_ENABLED()
+  return sparse_enabled &&
+    at::native::mkldnn_sparse_conv_available() &&
+    !input.is_mkldnn() && // density is estimated on dense inputs only
+    !transposed && // transposed convolutions scan in the backward data kernel
+    use_mkldnn(input) &&
+    sampled_row_density(input) < sparse_threshold;
+#endif
+  return false;
+}
+
 auto ConvParams::use_nnpack(const at::Tensor& input) const -> bool {
 #if AT_NNPACK_ENABLED()
   return at::_nnpack_available() &&
@@ -528,6 +579,8 @@ at::Tensor _convolution(
   params.benchmark = benchmark;
   params.deterministic = deterministic;
   params.cudnn_enabled = cudnn_enabled;
+  params.sparse_enabled = at::globalContext().sparseConvMkldnn();
+  params.sparse_threshold = at::globalContext().sparseConvMkldnnThreshold();
 
   check_shape_forward(input, weight, bias, params, input_is_mkldnn);
 
@@ -591,6 +644,17 @@ at::Tensor _convolution(
           input, weight, bias,
           params.padding, params.stride, params.dilation, params.groups, params.benchmark, params.deterministic);
     }
+  } else if (params.use_mkldnn_sparse(input)) {
+#if AT_MKLDNN_ENABLED()
+    TORCH_CHECK(input.type() == weight.type(),
+             "Input type (", input.type().toString(), ") and weight type (", weight.type().toString(),
+             ") should be the same");
+    TORCH_CHECK(!bias.defined() || (input.type() == bias.type()),
+             "Input type (", input.type().toString(), ") and bias type (", bias.type().toString(),
+             ") should be the same");
+    output = at::mkldnn_convolution_sparse(input, weight.contiguous(), bias.defined() ? bias.contiguous() : bias,
+                                           params.padding, params.stride, params.dilation, params.groups);
+#endif
   } else if (params.use_mkldnn(input)) {
 #if AT_MKLDNN_ENABLED()
     TORCH_CHECK(input.type() == weight.type(),
@@ -599,7 +663,11 @@ at::Tensor _convolution(
     TORCH_CHECK(!bias.defined() || (input.type() == bias.type()),
              "Input type (", input.type().toString(), ") and bias type (", bias.type().toString(),
              ") should be the same");
-    if (!input_is_mkldnn) {
+    if (params.transposed) {
+      output = at::mkldnn_convolution_transpose(
+          input, weight, bias,
+          params.padding, params.output_padding, params.stride, params.dilation, params.groups);
+    } else if (!input_is_mkldnn) {
       output = at::mkldnn_convolution(input, weight.contiguous(), bias.defined() ? bias.contiguous() : bias,
                                       params.padding, params.stride, params.dilation, params.groups);
     } else {
@@ -649,6 +717,8 @@ at::Tensor _convolution_nogroup(
   params.benchmark = false;
   params.deterministic = false;
   params.cudnn_enabled = false;
+  params.sparse_enabled = false;
+  params.sparse_threshold = 0;
 
   auto dim = input.ndimension();
   auto dilated = params.is_dilated();
@@ -728,6 +798,8 @@ std::tuple<Tensor,Tensor,Tensor> _convolution_double_backward(
   params.benchmark = benchmark;
   params.deterministic = deterministic;
   params.cudnn_enabled = cudnn_enabled;
+  params.sparse_enabled = false;
+  params.sparse_threshold = 0;
 
   // Compute ggO = conv(ggI, w) + conv(i, ggW) + ggb
   Tensor ggO;
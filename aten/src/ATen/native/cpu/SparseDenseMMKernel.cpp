@@ -0,0 +1,202 @@
+#include <ATen/native/cpu/SparseDenseMMKernel.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec256/vec256.h>
+
+namespace at { namespace native {
+namespace {
+
+// y += a * x, vectorized when both rows are contiguous
+template <typename scalar_t>
+inline void axpy(int64_t n, scalar_t a, const scalar_t* x, int64_t incx, scalar_t* y, int64_t incy) {
+  using Vec = vec256::Vec256<scalar_t>;
+  if (incx != 1 || incy != 1) {
+    for (int64_t k = 0; k < n; k++) {
+      y[k * incy] += a * x[k * incx];
+    }
+    return;
+  }
+  const Vec a_vec(a);
+  int64_t k = 0;
+  for (; k + Vec::size() <= n; k += Vec::size()) {
+    Vec y_vec = Vec::loadu(y + k) + a_vec * Vec::loadu(x + k);
+    y_vec.store(y + k);
+  }
+  for (; k < n; k++) {
+    y[k] += a * x[k];
+  }
+}
+
+// Number of chunks the nnz products are split into, one per thread unless
+// there is too little work to go around
+inline int64_t num_chunks(int64_t nnz, int64_t dim_k) {
+  const int64_t work = nnz * std::max<int64_t>(dim_k, 1);
+  return std::max<int64_t>(1, std::min<int64_t>(
+      at::get_num_threads(), work / at::internal::GRAIN_SIZE));
+}
+
+// SpMM of a coalesced matrix in compressed sparse row form: the row indices
+// of a coalesced COO matrix are sorted, so its column indices and values
+// already are the CSR ones and only the row pointers `csr` (of size dim_i + 1)
+// are needed. The rows are split into chunks of about the same nnz, so every
+// thread owns a disjoint range of output rows and accumulates each of them
+// while it is hot in cache.
+template <typename scalar_t>
+void addmm_sparse_dense_csr(Tensor& r, Scalar alpha, const Tensor& csr, const Tensor& col_indices, const Tensor& values, const Tensor& dense) {
+  const int64_t nnz = values.size(0);
+  const int64_t dim_i = r.size(0);
+  const int64_t dim_j = dense.size(0);
+  const int64_t dim_k = dense.size(1);
+
+  scalar_t cast_alpha = alpha.to<scalar_t>();
+  const int64_t* csr_ptr = csr.data<int64_t>();
+  const int64_t* col_ptr = col_indices.data<int64_t>();
+  const scalar_t* values_ptr = values.data<scalar_t>();
+  const scalar_t* dense_ptr = dense.data<scalar_t>();
+  scalar_t* r_ptr = r.data<scalar_t>();
+
+  int64_t dense_stride0 = dense.stride(0);
+  int64_t dense_stride1 = dense.stride(1);
+  int64_t r_stride0 = r.stride(0);
+  int64_t r_stride1 = r.stride(1);
+
+  // chunk boundaries in nnz, moved to the start of the row they fall in
+  const int64_t nchunks = num_chunks(nnz, dim_k);
+  std::vector<int64_t> chunk_rows(nchunks + 1, dim_i);
+  for (int64_t c = 0; c < nchunks; c++) {
+    const int64_t nnz_start = nnz * c / nchunks;
+    chunk_rows[c] = std::upper_bound(csr_ptr, csr_ptr + dim_i + 1, nnz_start) - csr_ptr - 1;
+  }
+  chunk_rows[0] = 0;
+
+  at::parallel_for(0, nchunks, 1, [&](int64_t c_begin, int64_t c_end) {
+    for (int64_t c = c_begin; c < c_end; c++) {
+      for (int64_t row = chunk_rows[c]; row < chunk_rows[c + 1]; row++) {
+        scalar_t* r_row = r_ptr + row * r_stride0;
+        for (int64_t p = csr_ptr[row]; p < csr_ptr[row + 1]; p++) {
+          int64_t col = col_ptr[p];
+          if (col < 0 || col >= dim_j) {
+            AT_ERROR("addmm: index out of column bound: ", col, " not between 1 and ", dim_j);
+          }
+          axpy<scalar_t>(dim_k,
+                cast_alpha * values_ptr[p],
+                dense_ptr + col * dense_stride0, dense_stride1,
+                r_row, r_stride1);
+        }
+      }
+    }
+  });
+}
+
+// Accumulates the products p in [start, end) of an uncoalesced matrix into
+// out, a dim_i x dim_k matrix with strides out_stride0 and out_stride1
+template <typename scalar_t>
+void addmm_sparse_dense_coo_range(int64_t start, int64_t end, int64_t dim_i, int64_t dim_j, int64_t dim_k, scalar_t* out, int64_t out_stride0, int64_t out_stride1, scalar_t cast_alpha, const Tensor& indices, const Tensor& values, const Tensor& dense) {
+  auto indices_accessor = indices.accessor<int64_t, 2>();
+  auto values_accessor = values.accessor<scalar_t, 1>();
+  const scalar_t* dense_ptr = dense.data<scalar_t>();
+
+  int64_t dense_stride0 = dense.stride(0);
+  int64_t dense_stride1 = dense.stride(1);
+  for (int64_t i = start; i < end; i++) {
+    scalar_t val = values_accessor[i];
+    int64_t row = indices_accessor[0][i];
+    int64_t col = indices_accessor[1][i];
+    if (col >= 0 && col < dim_j && row >= 0 && row < dim_i) {
+      axpy<scalar_t>(dim_k,
+            cast_alpha * val,
+            dense_ptr + col * dense_stride0, dense_stride1,
+            out + row * out_stride0, out_stride1);
+    } else {
+      if (col < 0 || col >= dim_j) {
+        AT_ERROR("addmm: index out of column bound: ", col, " not between 1 and ", dim_j);
+      } else {
+        AT_ERROR("addmm: index out of row bound: ", row, " not between 1 and ", dim_i);
+      }
+    }
+  }
+}
+
+// SpMM of an uncoalesced matrix, whose products for one output row may be
+// anywhere in the nnz. The nnz are split evenly and every chunk accumulates
+// into its own zeroed dim_i x dim_k buffer, which are then summed into r row
+// by row. The buffers cost about as much to clear and reduce as dim_i rows of
+// products each, so they are only used when every chunk has more products
+// than that; otherwise the products are accumulated serially.
+template <typename scalar_t>
+void addmm_sparse_dense_coo(Tensor& r, Scalar alpha, const Tensor& indices, const Tensor& values, const Tensor& dense) {
+  const int64_t nnz = values.size(0);
+  const int64_t dim_i = r.size(0);
+  const int64_t dim_j = dense.size(0);
+  const int64_t dim_k = dense.size(1);
+
+  scalar_t cast_alpha = alpha.to<scalar_t>();
+  scalar_t* r_ptr = r.data<scalar_t>();
+  int64_t r_stride0 = r.stride(0);
+  int64_t r_stride1 = r.stride(1);
+
+  const int64_t nchunks = num_chunks(nnz, dim_k);
+  if (nchunks == 1 || dim_i > nnz / nchunks) {
+    addmm_sparse_dense_coo_range<scalar_t>(0, nnz, dim_i, dim_j, dim_k,
+        r_ptr, r_stride0, r_stride1, cast_alpha, indices, values, dense);
+    return;
+  }
+
+  Tensor buffers = at::zeros({nchunks, dim_i, dim_k}, r.options());
+  scalar_t* buffers_ptr = buffers.data<scalar_t>();
+  const int64_t buffer_size = dim_i * dim_k;
+  at::parallel_for(0, nchunks, 1, [&](int64_t c_begin, int64_t c_end) {
+    for (int64_t c = c_begin; c < c_end; c++) {
+      addmm_sparse_dense_coo_range<scalar_t>(nnz * c / nchunks, nnz * (c + 1) / nchunks,
+          dim_i, dim_j, dim_k, buffers_ptr + c * buffer_size, dim_k, 1,
+          cast_alpha, indices, values, dense);
+    }
+  });
+
+  at::parallel_for(0, dim_i, std::max<int64_t>(1, at::internal::GRAIN_SIZE / (nchunks * std::max<int64_t>(dim_k, 1))),
+      [&](int64_t row_begin, int64_t row_end) {
+    for (int64_t row = row_begin; row < row_end; row++) {
+      for (int64_t c = 0; c < nchunks; c++) {
+        axpy<scalar_t>(dim_k, 1,
+            buffers_ptr + c * buffer_size + row * dim_k, 1,
+            r_ptr + row * r_stride0, r_stride1);
+      }
+    }
+  });
+}
+
+static void addmm_sparse_dense_csr_kernel_impl(
+    Tensor& r,
+    Scalar alpha,
+    const Tensor& csr,
+    const Tensor& col_indices,
+    const Tensor& values,
+    const Tensor& dense) {
+  AT_DISPATCH_ALL_TYPES(
+      values.scalar_type(), "addmm_sparse_dense_csr_kernel_impl", [&] {
+        addmm_sparse_dense_csr<scalar_t>(r, alpha, csr, col_indices, values, dense);
+      });
+}
+
+static void addmm_sparse_dense_coo_kernel_impl(
+    Tensor& r,
+    Scalar alpha,
+    const Tensor& indices,
+    const Tensor& values,
+    const Tensor& dense) {
+  AT_DISPATCH_ALL_TYPES(
+      values.scalar_type(), "addmm_sparse_dense_coo_kernel_impl", [&] {
+        addmm_sparse_dense_coo<scalar_t>(r, alpha, indices, values, dense);
+      });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(addmm_sparse_dense_csr_stub, &addmm_sparse_dense_csr_kernel_impl);
+REGISTER_DISPATCH(addmm_sparse_dense_coo_stub, &addmm_sparse_dense_coo_kernel_impl);
+
+}} // namespace at::native
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at {
+namespace native {
+
+// r += alpha * mm(S, dense) for a dim_i x dim_j sparse matrix S, where r is
+// dim_i x dim_k and dense is dim_j x dim_k.
+// The CSR kernel takes the row pointers and the column indices and values of
+// a coalesced S; the COO kernel takes the indices and values of any S.
+using addmm_sparse_dense_csr_fn = void(*)(
+    Tensor& /* r */,
+    Scalar /* alpha */,
+    const Tensor& /* csr */,
+    const Tensor& /* col_indices */,
+    const Tensor& /* values */,
+    const Tensor& /* dense */);
+using addmm_sparse_dense_coo_fn = void(*)(
+    Tensor& /* r */,
+    Scalar /* alpha */,
+    const Tensor& /* indices */,
+    const Tensor& /* values */,
+    const Tensor& /* dense */);
+
+DECLARE_DISPATCH(addmm_sparse_dense_csr_fn, addmm_sparse_dense_csr_stub);
+DECLARE_DISPATCH(addmm_sparse_dense_coo_fn, addmm_sparse_dense_coo_stub);
+
+}
+}
@@ -41,6 +41,7 @@ Tensor& mkldnn_mul_(Tensor& self, const Tensor& other) {
 #else // AT_MKLDNN_EBABLED
 
 #include <ATen/native/mkldnn/MKLDNNCommon.h>
+#include <ATen/native/mkldnn/RowOccupancy.h>
 
 namespace at {
 namespace native {
@@ -57,6 +58,11 @@ Tensor& mkldnn_add_out(
   const std::vector<float> scales{1.0, alpha.to<float>()};
   ideep::sum::compute<AllocForMKLDNN>(scales, {x, y}, z);
 
+  mkldnn_set_row_occupancy(
+      result,
+      add_row_occupancy(
+          mkldnn_row_occupancy(self), mkldnn_row_occupancy(other),
+          self.dim() == 4 ? self.size(1) : 0, alpha));
   return result;
 }
 
@@ -68,7 +74,13 @@ Tensor mkldnn_add(const Tensor& self, const Tensor& other, Scalar alpha) {
   const std::vector<float> scales{1.0, alpha.to<float>()};
   ideep::sum::compute<AllocForMKLDNN>(scales, {x, y}, z);
 
-  return new_with_itensor_mkldnn(std::move(z), self.options());
+  Tensor result = new_with_itensor_mkldnn(std::move(z), self.options());
+  mkldnn_set_row_occupancy(
+      result,
+      add_row_occupancy(
+          mkldnn_row_occupancy(self), mkldnn_row_occupancy(other),
+          self.dim() == 4 ? self.size(1) : 0, alpha));
+  return result;
 }
 
 Tensor& mkldnn_add_(Tensor& self, const Tensor& other, Scalar alpha) {
@@ -87,6 +99,12 @@ Tensor& mkldnn_mul_out(Tensor& result, const Tensor& self, const Tensor& other)
       x, z, ideep::algorithm::eltwise_linear,
       ideep::prop_kind::forward_inference, /*alpha*/ other.item().to<float>());
 
+    const float scale = other.item().to<float>();
+    mkldnn_set_row_occupancy(
+        result,
+        eltwise_row_occupancy(
+            mkldnn_row_occupancy(self), self.dim() == 4 ? self.size(1) : 0,
+            [scale](const Tensor& background) { return background * scale; }));
     return result;
   } else {
     AT_ASSERTM(self.sizes() == other.sizes(),
@@ -95,6 +113,7 @@ Tensor& mkldnn_mul_out(Tensor& result, const Tensor& self, const Tensor& other)
     auto op = ideep::eltwise_binary::eltwise_binary_op::ELTWISE_MUL;
     ideep::eltwise_binary::compute<AllocForMKLDNN>(op, x, y, z);
 
+    mkldnn_set_row_occupancy(result);
     return result;
   }
 }
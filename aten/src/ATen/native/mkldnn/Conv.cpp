@@ -12,6 +12,58 @@ at::Tensor mkldnn_convolution(
   AT_ERROR("mkldnn_convolution_forward: ATen not compiled with MKLDNN support");
 }
 
+at::Tensor mkldnn_convolution_sparse(
+    const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias,
+    IntArrayRef padding, IntArrayRef stride, IntArrayRef dilation, int64_t groups,
+    const at::Tensor& row_mask) {
+  AT_ERROR("mkldnn_convolution_sparse: ATen not compiled with MKLDNN support");
+}
+
+bool _mkldnn_sparse_conv_available() {
+  return false;
+}
+
+at::Tensor mkldnn_convolution_relu(
+    const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias,
+    IntArrayRef padding, IntArrayRef stride, IntArrayRef dilation, int64_t groups) {
+  AT_ERROR("mkldnn_convolution_relu: ATen not compiled with MKLDNN support");
+}
+
+at::Tensor mkldnn_convolution_sum_relu(
+    const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias,
+    const at::Tensor& other, IntArrayRef padding, IntArrayRef stride,
+    IntArrayRef dilation, int64_t groups) {
+  AT_ERROR("mkldnn_convolution_sum_relu: ATen not compiled with MKLDNN support");
+}
+
+at::Tensor mkldnn_convolution_delta(
+    const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias,
+    IntArrayRef padding, IntArrayRef stride, IntArrayRef dilation, int64_t groups,
+    const at::Tensor& prev_input, const at::Tensor& prev_output) {
+  AT_ERROR("mkldnn_convolution_delta: ATen not compiled with MKLDNN support");
+}
+
+at::Tensor mkldnn_convolution_nhwc(
+    const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias,
+    IntArrayRef padding, IntArrayRef stride, IntArrayRef dilation, int64_t groups,
+    double scale, const at::Tensor& mean, const at::Tensor& std) {
+  AT_ERROR("mkldnn_convolution_nhwc: ATen not compiled with MKLDNN support");
+}
+
+at::Tensor mkldnn_convolution_transpose(
+    const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias,
+    IntArrayRef padding, IntArrayRef output_padding, IntArrayRef stride,
+    IntArrayRef dilation, int64_t groups) {
+  AT_ERROR("mkldnn_convolution_transpose: ATen not compiled with MKLDNN support");
+}
+
+std::tuple<at::Tensor,at::Tensor,at::Tensor> mkldnn_convolution_transpose_backward(
+    const at::Tensor& input, const at::Tensor& grad_output, const at::Tensor& weight,
+    IntArrayRef padding, IntArrayRef output_padding, IntArrayRef stride, IntArrayRef dilation,
+    int64_t groups, std::array<bool,3> output_mask) {
+  AT_ERROR("mkldnn_convolution_transpose_backward: ATen not compiled with MKLDNN support");
+}
+
 at::Tensor mkldnn_convolution_backward_input(
     IntArrayRef input_size, const at::Tensor& grad_output, const at::Tensor& weight,
     IntArrayRef padding, IntArrayRef stride, IntArrayRef dilation, int64_t groups, bool bias_defined) {
@@ -36,6 +88,7 @@ std::tuple<at::Tensor,at::Tensor,at::Tensor> mkldnn_convolution_backward(
 
 #include <ATen/mkldnn/Runtime.h>
 #include <ATen/native/mkldnn/MKLDNNCommon.h>
+#include <ATen/native/mkldnn/RowOccupancy.h>
 #include <ATen/native/mkldnn/Utils.h>
 
 using namespace mkldnn;
@@ -53,6 +106,35 @@ inline ideep::tensor get_mkldnn_tensor(const at::Tensor& tensor) {
     return at::native::itensor_view_from_dense(tensor);
   }
 }
+
+// Post-ops applied by the convolution to its output
+enum class ConvFusion { None, Relu, Sum, SumRelu };
+
+inline ideep::descriptor_group::attr_t conv_fusion_attr(ConvFusion fusion) {
+  switch (fusion) {
+    case ConvFusion::Relu:
+      return ideep::descriptor_group::attr_t::fuse_relu();
+    case ConvFusion::Sum:
+      return ideep::descriptor_group::attr_t::fuse_sum();
+    case ConvFusion::SumRelu:
+      return ideep::descriptor_group::attr_t::residual();
+    default:
+      return ideep::descriptor_group::attr_t{};
+  }
+}
+
+inline bool conv_fusion_has_sum(ConvFusion fusion) {
+  return fusion == ConvFusion::Sum || fusion == ConvFusion::SumRelu;
+}
+
+// The sparse mode of the backward passes and the fused convolutions,
+// requested by torch.backends.mkldnn.sparse_conv. The forward pass is routed
+// to mkldnn_convolution_sparse by at::_convolution instead.
+inline at::native::SparseConvMode default_sparse_conv_mode() {
+  return at::globalContext().sparseConvMkldnn()
+      ? at::native::SparseConvMode::Scan
+      : at::native::SparseConvMode::Dense;
+}
 }
 
 namespace at { namespace native {
@@ -64,7 +146,11 @@ ideep::tensor _mkldnn_conv2d(
     at::IntArrayRef padding,
     at::IntArrayRef stride,
     at::IntArrayRef dilation,
-    int64_t groups) {
+    int64_t groups,
+    SparseConvMode sparse_mode,
+    const at::Tensor& row_mask,
+    const ideep::descriptor_group::attr_t& attr,
+    const c10::optional<ideep::tensor>& sum) {
   std::vector<int64_t> kernel_size(x.ndims());
   // mkldnn conv2d weights could have been re-ordered to 5d by
   // mkldnn_reorder_conv2d_weight
@@ -84,12 +170,34 @@ ideep::tensor _mkldnn_conv2d(
   std::vector<int64_t> output_sizes =
       conv_output_size(input_size, kernel_size, padding, stride, dilation);
 
-  ideep::tensor y;
-  if (b.has_value()) {
-    ideep::convolution_forward::compute<AllocForMKLDNN>(
+  if (sparse_mode == SparseConvMode::RowMask) {
+    TORCH_CHECK(
+        row_mask.size(0) == x_dims[0] && row_mask.size(1) == x_dims[2],
+        "mkldnn_convolution_sparse: expected a row mask of shape [",
+        x_dims[0], ", ", x_dims[2], "], but got ", row_mask.sizes());
+  }
+  SparseConvGuard sparse_guard(sparse_mode, row_mask);
+
+  auto compute = [&](ideep::tensor& y) {
+    if (b.has_value()) {
+      ideep::convolution_forward::compute<AllocForMKLDNN>(
+          x,
+          w,
+          b.value(),
+          {output_sizes.cbegin(), output_sizes.cend()},
+          y,
+          {stride.begin(), stride.end()},
+          {dilation.begin(), dilation.end()},
+          {padding.begin(), padding.end()},
+          {padding.begin(), padding.end()},
+          groups,
+          attr,
+          ideep::algorithm::convolution_direct,
+          ideep::prop_kind::forward);
+    } else {
+      ideep::convolution_forward::compute<AllocForMKLDNN>(
         x,
         w,
-        b.value(),
         {output_sizes.cbegin(), output_sizes.cend()},
         y,
         {stride.begin(), stride.end()},
@@ -97,41 +205,131 @@ ideep::tensor _mkldnn_conv2d(
         {padding.begin(), padding.end()},
         {padding.begin(), padding.end()},
         groups,
-        ideep::descriptor_group::attr_t{},
+        attr,
         ideep::algorithm::convolution_direct,
         ideep::prop_kind::forward);
-  } else {
-    ideep::convolution_forward::compute<AllocForMKLDNN>(
-      x,
-      w,
+    }
+  };
+
+  ideep::tensor y;
+  if (!sum.has_value()) {
+    compute(y);
+    return y;
+  }
+
+  // The sum post-op accumulates into the destination, which therefore starts
+  // as a copy of `sum` in the layout the convolution writes. Ask the
+  // primitive for that layout first, so that `sum` is reordered once and the
+  // convolution runs once.
+  const ideep::param::dims sum_dims = sum->get_dims();
+  std::vector<int64_t> sum_sizes{sum_dims.cbegin(), sum_dims.cend()};
+  TORCH_CHECK(
+      sum_sizes == output_sizes,
+      "mkldnn_convolution: expected the summand of size ",
+      IntArrayRef(output_sizes), ", but got ", IntArrayRef(sum_sizes));
+  ideep::tensor w_grouped = w.as_weights();
+  w_grouped.make_group(groups);
+  const ideep::tensor::descriptor dst_any(
       {output_sizes.cbegin(), output_sizes.cend()},
-      y,
-      {stride.begin(), stride.end()},
-      {dilation.begin(), dilation.end()},
-      {padding.begin(), padding.end()},
-      {padding.begin(), padding.end()},
-      groups,
-      ideep::descriptor_group::attr_t{},
-      ideep::algorithm::convolution_direct,
-      ideep::prop_kind::forward);
+      x.get_data_type(),
+      ideep::format::any);
+  const ideep::tensor::descriptor dst_desc = b.has_value()
+      ? ideep::convolution_forward(
+            x.get_descriptor(),
+            w_grouped.get_descriptor(),
+            b->get_descriptor(),
+            dst_any,
+            {stride.begin(), stride.end()},
+            {dilation.begin(), dilation.end()},
+            {padding.begin(), padding.end()},
+            {padding.begin(), padding.end()},
+            attr,
+            ideep::algorithm::convolution_direct,
+            ideep::prop_kind::forward).expected_dst_descriptor()
+      : ideep::convolution_forward(
+            x.get_descriptor(),
+            w_grouped.get_descriptor(),
+            dst_any,
+            {stride.begin(), stride.end()},
+            {dilation.begin(), dilation.end()},
+            {padding.begin(), padding.end()},
+            {padding.begin(), padding.end()},
+            attr,
+            ideep::algorithm::convolution_direct,
+            ideep::prop_kind::forward).expected_dst_descriptor();
+
+  y.init<AllocForMKLDNN>(dst_desc);
+  y.feed_from(sum.value());
+  compute(y);
+  // ideep only keeps the buffer, and so the summand, in the layout it
+  // expects; should it have picked another one, redo the convolution on a
+  // copy in that layout
+  if (y.get_descriptor() != dst_desc) {
+    ideep::tensor y_reordered;
+    y_reordered.init<AllocForMKLDNN>(y.get_descriptor());
+    y_reordered.feed_from(sum.value());
+    compute(y_reordered);
+    return y_reordered;
   }
   return y;
 }
 
-at::Tensor mkldnn_convolution(
+static at::Tensor _mkldnn_convolution(
     const at::Tensor& input,
     const at::Tensor& weight,
     const at::Tensor& bias,
     IntArrayRef padding,
     IntArrayRef stride,
     IntArrayRef dilation,
-    int64_t groups) {
-  const ideep::tensor mkldnn_input = get_mkldnn_tensor(input);
+    int64_t groups,
+    SparseConvMode sparse_mode,
+    const at::Tensor& row_mask,
+    ConvFusion fusion = ConvFusion::None,
+    const at::Tensor& other = at::Tensor()) {
+  // Rows known to be zero, from the caller or from the occupancy an MKL-DNN
+  // input carries from the previous layers
+  MKLDNNRowOccupancy occupancy;
+  if (row_mask.defined()) {
+    occupancy.rows = row_mask;
+  } else if (input.is_mkldnn()) {
+    occupancy = mkldnn_row_occupancy(input);
+    if (occupancy.defined() && !occupancy.zero_background()) {
+      occupancy = MKLDNNRowOccupancy();
+    }
+    // the attached mask replaces the scan of the sparse convolution, and
+    // turns the dense one sparse under the same conditions as at::_convolution
+    auto& ctx = at::globalContext();
+    if (occupancy.defined() &&
+        (sparse_mode == SparseConvMode::Scan ||
+         (ctx.sparseConvMkldnn() &&
+          occupancy.rows.sum().item<double>() <
+              ctx.sparseConvMkldnnThreshold() * occupancy.rows.numel()))) {
+      sparse_mode = SparseConvMode::RowMask;
+    }
+  }
+
+  // A dense input would be reordered to nChw16c inside the convolution and
+  // then scanned for empty rows; do both in a single pass that skips them
+  Tensor blocked_input;
+  if (!input.is_mkldnn() && !row_mask.defined() &&
+      sparse_mode == SparseConvMode::Scan && mkldnn_sparse_conv_available() &&
+      input.dim() == 4 && (input.size(1) / groups) % 16 == 0) {
+    blocked_input = dense_to_mkldnn_rows(input.contiguous(), /*blocked=*/true);
+    occupancy = mkldnn_row_occupancy(blocked_input);
+    sparse_mode = SparseConvMode::RowMask;
+  }
+
+  const ideep::tensor mkldnn_input =
+      get_mkldnn_tensor(blocked_input.defined() ? blocked_input : input);
   const ideep::tensor mkldnn_weight = get_mkldnn_tensor(weight);
   c10::optional<ideep::tensor> mkldnn_bias{c10::nullopt};
   if (bias.defined()) {
     mkldnn_bias = get_mkldnn_tensor(bias);
   }
+  c10::optional<ideep::tensor> mkldnn_other{c10::nullopt};
+  if (conv_fusion_has_sum(fusion)) {
+    mkldnn_other = get_mkldnn_tensor(other);
+  }
 
   ideep::tensor mkldnn_output = _mkldnn_conv2d(
       mkldnn_input,
@@ -140,16 +338,224 @@ at::Tensor mkldnn_convolution(
       padding,
       stride,
       dilation,
-      groups);
+      groups,
+      sparse_mode,
+      sparse_mode == SparseConvMode::RowMask ? occupancy.rows : Tensor(),
+      conv_fusion_attr(fusion),
+      mkldnn_other);
 
   if (input.is_mkldnn()) {
-    return new_with_itensor_mkldnn(std::move(mkldnn_output), input.options());
+    Tensor output =
+        new_with_itensor_mkldnn(std::move(mkldnn_output), input.options());
+    // rows of zeros in all of their receptive field come out as the bias
+    if (occupancy.defined()) {
+      MKLDNNRowOccupancy output_occupancy;
+      output_occupancy.rows = dilate_row_mask(
+          occupancy.rows,
+          output.size(2),
+          weight.size(weight.dim() - 2),
+          stride[0],
+          padding[0],
+          dilation[0]);
+      if (bias.defined()) {
+        output_occupancy.background =
+            bias.is_mkldnn() ? mkldnn_to_dense(bias) : bias.contiguous();
+      }
+      // and then go through the post-ops like every other row
+      if (conv_fusion_has_sum(fusion)) {
+        output_occupancy = other.is_mkldnn()
+            ? add_row_occupancy(output_occupancy, mkldnn_row_occupancy(other),
+                                output.size(1), 1)
+            : MKLDNNRowOccupancy();
+      }
+      if (fusion == ConvFusion::Relu || fusion == ConvFusion::SumRelu) {
+        output_occupancy = eltwise_row_occupancy(
+            output_occupancy, output.size(1),
+            [](const Tensor& background) { return background.clamp_min(0); });
+      }
+      mkldnn_set_row_occupancy(output, std::move(output_occupancy));
+    }
+    return output;
   } else {
     return mkldnn_to_dense(
         new_with_itensor_mkldnn(std::move(mkldnn_output), input.options()));
   }
 }
 
+at::Tensor mkldnn_convolution(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const at::Tensor& bias,
+    IntArrayRef padding,
+    IntArrayRef stride,
+    IntArrayRef dilation,
+    int64_t groups) {
+  return _mkldnn_convolution(
+      input, weight, bias, padding, stride, dilation, groups,
+      SparseConvMode::Dense, Tensor());
+}
+
+// Convolution that skips all-zero input rows regardless of
+// torch.backends.mkldnn.sparse_conv, which makes at::_convolution pick it
+// for inputs with few non-zero rows. The rows are found by scanning the
+// input, or taken from `row_mask` when given: a tensor of shape [N, H],
+// [N, H, W] or [N, C, H, W] whose non-zero entries mark the pixels that may
+// be non-zero, e.g. a background-subtraction mask. The row occupancy of an
+// MKL-DNN input (see MKLDNNRowOccupancy) stands in for a missing mask.
+at::Tensor mkldnn_convolution_sparse(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const at::Tensor& bias,
+    IntArrayRef padding,
+    IntArrayRef stride,
+    IntArrayRef dilation,
+    int64_t groups,
+    const at::Tensor& row_mask) {
+  TORCH_CHECK(input.dim() == 4,
+      "mkldnn_convolution_sparse: expected 4-D input, but got ",
+      input.dim(), "-D");
+  if (!row_mask.defined()) {
+    return _mkldnn_convolution(
+        input, weight, bias, padding, stride, dilation, groups,
+        SparseConvMode::Scan, Tensor());
+  }
+  return _mkldnn_convolution(
+      input, weight, bias, padding, stride, dilation, groups,
+      SparseConvMode::RowMask, mkldnn_row_mask_from(row_mask));
+}
+
+bool _mkldnn_sparse_conv_available() {
+  return mkldnn_sparse_conv_available();
+}
+
+// relu(conv(input)), with the ReLU applied by the convolution as a post-op
+// instead of in a separate pass over the output
+at::Tensor mkldnn_convolution_relu(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const at::Tensor& bias,
+    IntArrayRef padding,
+    IntArrayRef stride,
+    IntArrayRef dilation,
+    int64_t groups) {
+  return _mkldnn_convolution(
+      input, weight, bias, padding, stride, dilation, groups,
+      default_sparse_conv_mode(), Tensor(), ConvFusion::Relu);
+}
+
+// relu(conv(input) + other), the tail of a residual block. The convolution
+// accumulates into a copy of `other`, which is cheapest when `other` already
+// has the layout of the convolution output, e.g. when it comes from another
+// MKL-DNN convolution.
+at::Tensor mkldnn_convolution_sum_relu(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const at::Tensor& bias,
+    const at::Tensor& other,
+    IntArrayRef padding,
+    IntArrayRef stride,
+    IntArrayRef dilation,
+    int64_t groups) {
+  TORCH_CHECK(input.is_mkldnn() == other.is_mkldnn(),
+      "mkldnn_convolution_sum_relu: expected input and other to be both "
+      "MKL-DNN or both dense tensors");
+  const Tensor other_cont = other.is_mkldnn() ? other : other.contiguous();
+  return _mkldnn_convolution(
+      input, weight, bias, padding, stride, dilation, groups,
+      default_sparse_conv_mode(), Tensor(), ConvFusion::SumRelu, other_cont);
+}
+
+// Convolution of a video frame given the previous frame and its output:
+// by linearity conv(input) = prev_output + conv(input - prev_input) without
+// bias, and the rows of the difference are zero wherever the frames agree.
+// The sparse kernel skips them and leaves the summed prev_output in place,
+// so only the output rows whose receptive field changed are recomputed.
+// Without a previous frame this is the plain convolution. Rounding errors
+// accumulate over a long chain of deltas; restarting it every few hundred
+// frames bounds them.
+at::Tensor mkldnn_convolution_delta(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const at::Tensor& bias,
+    IntArrayRef padding,
+    IntArrayRef stride,
+    IntArrayRef dilation,
+    int64_t groups,
+    const at::Tensor& prev_input,
+    const at::Tensor& prev_output) {
+  TORCH_CHECK(prev_input.defined() == prev_output.defined(),
+      "mkldnn_convolution_delta: expected both prev_input and prev_output or neither");
+  if (!prev_input.defined()) {
+    return _mkldnn_convolution(
+        input, weight, bias, padding, stride, dilation, groups,
+        default_sparse_conv_mode(), Tensor());
+  }
+  TORCH_CHECK(prev_input.sizes() == input.sizes(),
+      "mkldnn_convolution_delta: expected prev_input of size ", input.sizes(),
+      ", but got ", prev_input.sizes());
+  TORCH_CHECK(input.is_mkldnn() == prev_input.is_mkldnn() &&
+      input.is_mkldnn() == prev_output.is_mkldnn(),
+      "mkldnn_convolution_delta: expected input, prev_input and prev_output "
+      "to be all MKL-DNN or all dense tensors");
+
+  const Tensor delta = at::add(input, prev_input, -1);
+  if (delta.is_mkldnn()) {
+    // the union of the frames' occupancies would hide the unchanged rows
+    // from the scan of the sparse convolution
+    mkldnn_set_row_occupancy(delta);
+  }
+  const Tensor summand = prev_output.is_mkldnn() ? prev_output : prev_output.contiguous();
+  return _mkldnn_convolution(
+      delta, weight, Tensor(), padding, stride, dilation, groups,
+      SparseConvMode::Scan, Tensor(), ConvFusion::Sum, summand);
+}
+
+// Convolution of channels-last frames, e.g. straight from a video decoder
+// through torch.from_numpy: `input` is a [N, H, W, C] float or uint8 tensor
+// that is normalized to (input * scale - mean) / std on the fly. The layout
+// change, the normalization and the search for empty rows happen in one pass
+// over the pixels, in place of the NCHW conversion, the normalization and the
+// reorder to the blocked layout of the convolution. The empty rows are only
+// skipped when the normalization keeps zero at zero, i.e. without `mean`.
+// Returns the NCHW output as a dense tensor.
+at::Tensor mkldnn_convolution_nhwc(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const at::Tensor& bias,
+    IntArrayRef padding,
+    IntArrayRef stride,
+    IntArrayRef dilation,
+    int64_t groups,
+    double scale,
+    const at::Tensor& mean,
+    const at::Tensor& std) {
+  TORCH_CHECK(input.dim() == 4 && !input.is_mkldnn(),
+      "mkldnn_convolution_nhwc: expected a dense 4-D NHWC input");
+  TORCH_CHECK(input.scalar_type() == ScalarType::Float ||
+      input.scalar_type() == ScalarType::Byte,
+      "mkldnn_convolution_nhwc: expected a float or uint8 input, but got ",
+      input.scalar_type());
+  const int64_t channels = input.size(3);
+  TORCH_CHECK(!mean.defined() || mean.numel() == channels,
+      "mkldnn_convolution_nhwc: expected ", channels, " means, but got ",
+      mean.numel());
+  TORCH_CHECK(!std.defined() || std.numel() == channels,
+      "mkldnn_convolution_nhwc: expected ", channels, " stds, but got ",
+      std.numel());
+
+  const Tensor mkldnn_input = nhwc_to_mkldnn_rows(
+      input.contiguous(), scale, mean, std,
+      /*blocked=*/(channels / groups) % 16 == 0);
+  const SparseConvMode sparse_mode =
+      mkldnn_row_occupancy(mkldnn_input).zero_background() &&
+          mkldnn_sparse_conv_available()
+      ? SparseConvMode::Scan
+      : SparseConvMode::Dense;
+  return mkldnn_to_dense(_mkldnn_convolution(
+      mkldnn_input, weight, bias, padding, stride, dilation, groups,
+      sparse_mode, Tensor()));
+}
+
 Tensor mkldnn_convolution_backward_input(
     IntArrayRef input_size, const at::Tensor& grad_output, const at::Tensor& weight,
     IntArrayRef padding, IntArrayRef stride, IntArrayRef dilation, int64_t groups, bool bias_defined)
@@ -176,6 +582,9 @@ Tensor mkldnn_convolution_backward_input(
   int32_t sw = stride[1];
   int32_t ph = padding[0];
   int32_t pw = padding[1];
+  // MKL-DNN counts the dilation from 0
+  int32_t dh = dilation[0] - 1;
+  int32_t dw = dilation[1] - 1;
 
   auto data_t = memory::data_type::f32;
   auto format_any = memory::format::any;
@@ -187,6 +596,7 @@ Tensor mkldnn_convolution_backward_input(
   memory::dims bias_tz = {oc};
   memory::dims output_tz = {n, oc, oh, ow};
   memory::dims _stride = {sh, sw};
+  memory::dims _dilation = {dh, dw};
   memory::dims _padding = {ph, pw};
 
   auto input_md = memory::desc({input_tz}, data_t, format_any);
@@ -199,11 +609,11 @@ Tensor mkldnn_convolution_backward_input(
   if (bias_defined) {
     conv_forward_desc.reset(new convolution_forward::desc(prop_kind::forward,
       convolution_direct, input_md, weight_md, bias_md, output_md,
-      _stride, _padding, _padding, padding_kind::zero));
+      _stride, _dilation, _padding, _padding, padding_kind::zero));
   } else {
     conv_forward_desc.reset(new convolution_forward::desc(prop_kind::forward,
       convolution_direct, input_md, weight_md, output_md,
-      _stride, _padding, _padding, padding_kind::zero));
+      _stride, _dilation, _padding, _padding, padding_kind::zero));
   }
 
   std::shared_ptr<convolution_forward::primitive_desc> conv_forward_pd;
@@ -213,7 +623,7 @@ Tensor mkldnn_convolution_backward_input(
   std::shared_ptr<convolution_backward_data::desc> conv_backward_data_desc;
   conv_backward_data_desc.reset(new convolution_backward_data::desc(
     convolution_direct, input_md, weight_md, output_md,
-    _stride, _padding, _padding, padding_kind::zero));
+    _stride, _dilation, _padding, _padding, padding_kind::zero));
 
   std::shared_ptr<convolution_backward_data::primitive_desc> conv_backward_data_pd;
   conv_backward_data_pd.reset(new convolution_backward_data::primitive_desc(
@@ -257,6 +667,7 @@ Tensor mkldnn_convolution_backward_input(
     net.push_back(reorder(grad_input_memory, grad_input_usr_memory));
   }
 
+  SparseConvGuard sparse_guard(default_sparse_conv_mode());
   Stream::Instance().get_stream().submit(net);
 
   return grad_input;
@@ -293,6 +704,9 @@ std::tuple<at::Tensor, at::Tensor> mkldnn_convolution_backward_weights(
   int32_t sw = stride[1];
   int32_t ph = padding[0];
   int32_t pw = padding[1];
+  // MKL-DNN counts the dilation from 0
+  int32_t dh = dilation[0] - 1;
+  int32_t dw = dilation[1] - 1;
 
   auto data_t = memory::data_type::f32;
   auto format_any = memory::format::any;
@@ -305,6 +719,7 @@ std::tuple<at::Tensor, at::Tensor> mkldnn_convolution_backward_weights(
   memory::dims bias_tz = {oc};
   memory::dims output_tz = {n, oc, oh, ow};
   memory::dims _stride = {sh, sw};
+  memory::dims _dilation = {dh, dw};
   memory::dims _padding = {ph, pw};
 
   memory::desc input_md({input_tz}, data_t, format_any);
@@ -317,11 +732,11 @@ std::tuple<at::Tensor, at::Tensor> mkldnn_convolution_backward_weights(
   if (bias_defined) {
     conv_forward_desc.reset(new convolution_forward::desc(prop_kind::forward,
       convolution_direct, input_md, weight_md, bias_md, output_md,
-      _stride, _padding, _padding, padding_kind::zero));
+      _stride, _dilation, _padding, _padding, padding_kind::zero));
   } else {
     conv_forward_desc.reset(new convolution_forward::desc(prop_kind::forward,
       convolution_direct, input_md, weight_md, output_md,
-      _stride, _padding, _padding, padding_kind::zero));
+      _stride, _dilation, _padding, _padding, padding_kind::zero));
   }
 
   std::shared_ptr<convolution_forward::primitive_desc> conv_forward_pd;
@@ -332,11 +747,11 @@ std::tuple<at::Tensor, at::Tensor> mkldnn_convolution_backward_weights(
   if (bias_defined) {
     conv_backward_weight_desc.reset(new convolution_backward_weights::desc(
       convolution_direct, input_md, weight_md, bias_md, output_md,
-      _stride, _padding, _padding, padding_kind::zero));
+      _stride, _dilation, _padding, _padding, padding_kind::zero));
   } else {
     conv_backward_weight_desc.reset(new convolution_backward_weights::desc(
       convolution_direct, input_md, weight_md, output_md,
-      _stride, _padding, _padding, padding_kind::zero));
+      _stride, _dilation, _padding, _padding, padding_kind::zero));
   }
 
   std::shared_ptr<convolution_backward_weights::primitive_desc> conv_backward_weight_pd;
@@ -390,6 +805,7 @@ std::tuple<at::Tensor, at::Tensor> mkldnn_convolution_backward_weights(
     net.push_back(reorder(grad_weight_memory, grad_weight_usr_memory));
   }
 
+  SparseConvGuard sparse_guard(default_sparse_conv_mode());
   Stream::Instance().get_stream().submit(net);
 
   return std::tuple<at::Tensor, at::Tensor>{grad_weight, grad_bias};
@@ -414,6 +830,59 @@ std::tuple<at::Tensor,at::Tensor,at::Tensor> mkldnn_convolution_backward(
   return std::tuple<Tensor, Tensor, Tensor>{grad_input, grad_weight, grad_bias};
 }
 
+// The transposed convolution is the backward data pass of the convolution
+// with the same weight, input and output swapped; MKL-DNN runs it through
+// the sparse kernel too, which skips the all-zero rows of `input`.
+Tensor mkldnn_convolution_transpose(
+    const Tensor& input_t, const Tensor& weight, const Tensor& bias,
+    IntArrayRef padding, IntArrayRef output_padding, IntArrayRef stride,
+    IntArrayRef dilation, int64_t groups)
+{
+  Tensor input = input_t.is_mkldnn() ? input_t.to_dense() : input_t.contiguous();
+  Tensor weight_cont = weight.is_mkldnn() ? weight.to_dense() : weight.contiguous();
+
+  std::vector<int64_t> output_size{input.size(0), weight_cont.size(1) * groups};
+  for (size_t d = 0; d < 2; ++d) {
+    output_size.push_back(
+        (input.size(d + 2) - 1) * stride[d] - 2 * padding[d] +
+        dilation[d] * (weight_cont.size(d + 2) - 1) + output_padding[d] + 1);
+  }
+
+  Tensor output = at::mkldnn_convolution_backward_input(
+      output_size, input, weight_cont, padding, stride, dilation, groups, false);
+  if (bias.defined()) {
+    Tensor bias_dense = bias.is_mkldnn() ? bias.to_dense() : bias;
+    output.add_(bias_dense.reshape({1, -1, 1, 1}));
+  }
+  return input_t.is_mkldnn() ? output.to_mkldnn() : output;
+}
+
+std::tuple<at::Tensor,at::Tensor,at::Tensor> mkldnn_convolution_transpose_backward(
+    const at::Tensor& input_t, const at::Tensor& grad_output_t, const at::Tensor& weight,
+    IntArrayRef padding, IntArrayRef output_padding, IntArrayRef stride, IntArrayRef dilation,
+    int64_t groups, std::array<bool,3> output_mask)
+{
+  Tensor grad_output = grad_output_t.contiguous();
+  Tensor input = input_t.contiguous();
+  Tensor weight_cont = weight.contiguous();
+
+  Tensor grad_input, grad_weight, grad_bias;
+  if (output_mask[0]) {
+    // the convolution is the backward data pass of the transposed one
+    grad_input = at::mkldnn_convolution(
+      grad_output, weight_cont, Tensor(), padding, stride, dilation, groups);
+  }
+  if (output_mask[1]) {
+    std::tie(grad_weight, std::ignore) = at::mkldnn_convolution_backward_weights(
+      weight.sizes(), input, grad_output, padding, stride, dilation, groups, false);
+  }
+  if (output_mask[2]) {
+    grad_bias = grad_output.sum({0, 2, 3});
+  }
+
+  return std::tuple<Tensor, Tensor, Tensor>{grad_input, grad_weight, grad_bias};
+}
+
 }}  // namespace at::native
 
 #endif
@@ -1,11 +1,21 @@
 #include <ATen/native/mkldnn/MKLDNNCommon.h>
 #include <ATen/OpaqueTensorImpl.h>
+#include <ATen/SparseConvStats.h>
 #include <c10/core/Allocator.h>
 
 #if AT_MKLDNN_ENABLED()
 
 #include <ideep.hpp>
 
+// Provided by the sparse jit_avx512_common_convolution.cpp. The symbol is
+// weak so that builds against a stock MKL-DNN still link.
+#if defined(__GNUC__)
+extern "C" __attribute__((weak)) mkldnn_status_t mkldnn_sparse_conv_set_hint(
+    int mode, const uint8_t* row_mask, int mb, int nrows);
+extern "C" __attribute__((weak)) mkldnn_status_t mkldnn_sparse_conv_get_stats(
+    int64_t* stats);
+#endif
+
 namespace at { namespace native {
 
 /**
@@ -35,7 +45,14 @@ public:
   }
 };
 
-using IDeepTensorWrapper = IntrusivePtrTargetWrapper<ideep::tensor>;
+// Keeps the row occupancy of the activation next to the ideep tensor, it is
+// shared by all shallow copies, just like the data
+struct IDeepTensorWrapper : IntrusivePtrTargetWrapper<ideep::tensor> {
+  using IntrusivePtrTargetWrapper<ideep::tensor>::IntrusivePtrTargetWrapper;
+
+  MKLDNNRowOccupancy occupancy;
+};
+
 using IDeepTensorWrapperPtr = c10::intrusive_ptr<IDeepTensorWrapper>;
 using MKLDNNTensorImpl = OpaqueTensorImpl<IDeepTensorWrapperPtr>;
 using MKLDNNTensor = Tensor;
@@ -71,6 +88,106 @@ ideep::tensor itensor_view_from_dense(const Tensor& tensor) {
            ideep::tensor::data_type::f32},
           tensor.template data<float>()};
 }
+
+bool MKLDNNRowOccupancy::zero_background() const {
+  return !background.defined() || !background.ne(0).any().item<bool>();
+}
+
+MKLDNNRowOccupancy mkldnn_row_occupancy(const Tensor& mkldnn_tensor) {
+  AT_ASSERTM(mkldnn_tensor.is_mkldnn(),
+             "mkldnn_row_occupancy expects MKL-DNN tensor input");
+  MKLDNNTensorImpl *mklimpl = static_cast<MKLDNNTensorImpl *>(mkldnn_tensor.unsafeGetTensorImpl());
+  return mklimpl->unsafe_opaque_handle()->occupancy;
+}
+
+void mkldnn_set_row_occupancy(
+    const Tensor& mkldnn_tensor,
+    MKLDNNRowOccupancy occupancy) {
+  AT_ASSERTM(mkldnn_tensor.is_mkldnn(),
+             "mkldnn_set_row_occupancy expects MKL-DNN tensor input");
+  if (occupancy.defined()) {
+    AT_ASSERTM(
+        mkldnn_tensor.dim() == 4 && occupancy.rows.dim() == 2 &&
+            occupancy.rows.size(0) == mkldnn_tensor.size(0) &&
+            occupancy.rows.size(1) == mkldnn_tensor.size(2),
+        "mkldnn_set_row_occupancy: row mask does not match the tensor");
+    AT_ASSERTM(
+        !occupancy.background.defined() ||
+            occupancy.background.numel() == mkldnn_tensor.size(1),
+        "mkldnn_set_row_occupancy: background does not match the tensor");
+  }
+  MKLDNNTensorImpl *mklimpl = static_cast<MKLDNNTensorImpl *>(mkldnn_tensor.unsafeGetTensorImpl());
+  mklimpl->unsafe_opaque_handle()->occupancy = std::move(occupancy);
+}
+
+Tensor mkldnn_row_mask_from(const Tensor& mask) {
+  TORCH_CHECK(mask.dim() >= 2 && mask.dim() <= 4,
+      "expected a 2-D, 3-D or 4-D row mask, but got ", mask.dim(), "-D");
+  // reduce the mask to one flag per (n, h)
+  Tensor rows = mask.ne(0);
+  if (mask.dim() == 4) {
+    rows = rows.any(3).any(1);
+  } else if (mask.dim() == 3) {
+    rows = rows.any(2);
+  }
+  return rows.to(kByte).contiguous();
+}
+
+bool mkldnn_sparse_conv_available() {
+#if defined(__GNUC__)
+  return mkldnn_sparse_conv_set_hint != nullptr;
+#else
+  return false;
+#endif
+}
+
+SparseConvGuard::SparseConvGuard(SparseConvMode mode, const Tensor& row_mask) {
+  if (!mkldnn_sparse_conv_available()) {
+    return;
+  }
+  const uint8_t* mask_data = nullptr;
+  int mb = 0, nrows = 0;
+  if (mode == SparseConvMode::RowMask) {
+    AT_ASSERTM(
+        row_mask.dim() == 2 && row_mask.scalar_type() == ScalarType::Byte &&
+            row_mask.is_contiguous(),
+        "SparseConvGuard: expects a contiguous 2-D byte row mask");
+    mask_data = row_mask.data<uint8_t>();
+    mb = row_mask.size(0);
+    nrows = row_mask.size(1);
+  }
+#if defined(__GNUC__)
+  auto status = mkldnn_sparse_conv_set_hint(
+      static_cast<int>(mode), mask_data, mb, nrows);
+  AT_ASSERTM(status == mkldnn_success, "mkldnn_sparse_conv_set_hint failed");
+#endif
+}
+
+SparseConvGuard::~SparseConvGuard() {
+#if defined(__GNUC__)
+  // scanning is the default of the sparse convolution
+  if (mkldnn_sparse_conv_available()) {
+    mkldnn_sparse_conv_set_hint(
+        static_cast<int>(SparseConvMode::Scan), nullptr, 0, 0);
+  }
+  // hand the counters of the convolutions run under the guard to the
+  // profiler, see at::SparseConvStats
+  int64_t values[7];
+  if (mkldnn_sparse_conv_get_stats != nullptr &&
+      mkldnn_sparse_conv_get_stats(values) == mkldnn_success &&
+      values[0] > 0) {
+    SparseConvStats stats;
+    stats.calls = values[0];
+    stats.rows = values[1];
+    stats.rows_skipped = values[2];
+    stats.scan_ns = values[3];
+    stats.kernel_ns = values[4];
+    stats.thread_max_ns = values[5];
+    stats.thread_avg_ns = values[6];
+    sparse_conv_stats() += stats;
+  }
+#endif
+}
 }}
 
 #endif // AT_MKLDNN_ENABLED()
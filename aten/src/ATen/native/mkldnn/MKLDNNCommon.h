@@ -30,6 +30,60 @@ ideep::tensor& itensor_from_mkldnn(const Tensor& mkldnn_tensor);
 // Construct an `ideep::tensor` "view" from dense tensor, note the
 // ideep::tensor will share the underlying buffer
 ideep::tensor itensor_view_from_dense(const Tensor& tensor);
+
+// Row occupancy that travels alongside a 4-D MKL-DNN activation, so that
+// sparse convolutions deep in a network need not rediscover it. Every row
+// (n, h) with rows[n][h] == 0 holds background[c] in all pixels of channel
+// c; `rows` is a contiguous [N, H] byte tensor and `background` a [C] float
+// tensor, undefined when the background is zero. Ops producing an MKL-DNN
+// tensor update it analytically (see RowOccupancy.h), ops that cannot
+// leave it undefined, which is always correct.
+struct MKLDNNRowOccupancy {
+  Tensor rows;
+  Tensor background;
+
+  bool defined() const {
+    return rows.defined();
+  }
+  // Whether the rows outside the mask are all zero, so that the sparse
+  // convolution may skip them
+  bool zero_background() const;
+};
+
+// Occupancy attached to an MKL-DNN tensor, undefined if there is none
+MKLDNNRowOccupancy mkldnn_row_occupancy(const Tensor& mkldnn_tensor);
+
+// Attaches `occupancy` to an MKL-DNN tensor; an undefined one detaches it.
+// In-place ops have to call this, since the old occupancy became stale.
+void mkldnn_set_row_occupancy(
+    const Tensor& mkldnn_tensor,
+    MKLDNNRowOccupancy occupancy = MKLDNNRowOccupancy());
+
+// Reduces a mask of shape [N, H], [N, H, W] or [N, C, H, W] to the
+// contiguous [N, H] byte row mask taken by SparseConvGuard
+Tensor mkldnn_row_mask_from(const Tensor& mask);
+
+// How MKL-DNN convolutions find the all-zero input rows they can skip:
+// not at all, by scanning the input, or from a precomputed row mask.
+enum class SparseConvMode { Dense = 0, Scan = 1, RowMask = 2 };
+
+// Returns whether the linked MKL-DNN implements sparse row skipping, i.e.
+// it was built with the sparse jit_avx512_common_convolution.cpp
+bool mkldnn_sparse_conv_available();
+
+// Sets the sparse convolution mode for the MKL-DNN convolutions executed on
+// the current thread while the guard is alive. `row_mask` is a contiguous
+// byte tensor of shape [N, H] (non-zero = the input row is not all zero)
+// and has to outlive the guard. Falls back to dense convolution when the
+// linked MKL-DNN has no sparse support. On destruction the counters of those
+// convolutions are added to at::sparse_conv_stats().
+struct SparseConvGuard {
+  explicit SparseConvGuard(SparseConvMode mode, const Tensor& row_mask = Tensor());
+  ~SparseConvGuard();
+
+  SparseConvGuard(const SparseConvGuard&) = delete;
+  SparseConvGuard& operator=(const SparseConvGuard&) = delete;
+};
 }}
 
 #endif // AT_MKLDNN_ENABLED
@@ -2,6 +2,7 @@
 #include <ATen/NativeFunctions.h>
 #include <ATen/Config.h>
 #include <ATen/native/mkldnn/MKLDNNCommon.h>
+#include <ATen/native/mkldnn/RowOccupancy.h>
 #include <ATen/native/utils/ParamUtils.h>
 
 namespace at { namespace native {
@@ -28,6 +29,11 @@ Tensor dense_to_mkldnn(const Tensor& cpu_tensor) {
              "Can't convert cpu tensor with the number of dimensions > 5");
   // TODO: consider to convert non-contiguous tensor to `ideep::tensor` directly.
   auto cpu_tensor_cont = cpu_tensor.contiguous();
+  // Activations headed for sparse convolutions skip their empty rows and
+  // carry the row mask, so the first convolution need not scan for it
+  if (cpu_tensor_cont.dim() == 4 && globalContext().sparseConvMkldnn()) {
+    return dense_to_mkldnn_rows(cpu_tensor_cont, /*blocked=*/false);
+  }
   Tensor mkldnn_tensor = empty_mkldnn(cpu_tensor_cont.sizes(), cpu_tensor_cont.options());
   ideep::tensor& dtensor = itensor_from_mkldnn(mkldnn_tensor);
   dtensor.feed_from(dtensor.get_dims(),
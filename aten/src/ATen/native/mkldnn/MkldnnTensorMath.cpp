@@ -39,6 +39,7 @@ Tensor& mkldnn_zero_(Tensor& self) {
         end - begin);
   });
 
+  mkldnn_set_row_occupancy(self);
   return self;
 }
 
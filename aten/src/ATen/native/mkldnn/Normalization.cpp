@@ -26,6 +26,7 @@ std::tuple<Tensor, Tensor, Tensor> mkldnn_batch_norm(
 #else // AT_MKLDNN_EBABLED
 
 #include <ATen/native/mkldnn/MKLDNNCommon.h>
+#include <ATen/native/mkldnn/RowOccupancy.h>
 
 namespace at {
 namespace native {
@@ -64,8 +65,22 @@ std::tuple<Tensor, Tensor, Tensor> mkldnn_batch_norm(
                "mkldnn_batch_norm: currently mkldnn only support 2d and 3d batchnorm");
     ideep::batch_normalization_forward_inference::compute<AllocForMKLDNN>(
         x, m, v, w, b, y, eps);
+    Tensor output = new_with_itensor_mkldnn(std::move(y), input.options());
+    // inference batch norm is a per-channel affine map
+    auto occupancy = mkldnn_row_occupancy(input);
+    if (occupancy.defined()) {
+      Tensor scale = mkldnn_to_dense(weight) /
+          (mkldnn_to_dense(running_var) + eps).sqrt();
+      Tensor shift = mkldnn_to_dense(bias) - mkldnn_to_dense(running_mean) * scale;
+      mkldnn_set_row_occupancy(
+          output,
+          eltwise_row_occupancy(
+              occupancy, input.size(1), [&](const Tensor& background) {
+                return background * scale + shift;
+              }));
+    }
     return std::make_tuple(
-        new_with_itensor_mkldnn(std::move(y), input.options()),
+        output,
         new_with_itensor_mkldnn(ideep::tensor{}, input.options()),
         new_with_itensor_mkldnn(ideep::tensor{}, input.options()));
   }
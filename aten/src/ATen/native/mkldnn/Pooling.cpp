@@ -62,6 +62,7 @@ Tensor& mkldnn_adaptive_avg_pool2d_out(
 #else // AT_MKLDNN_ENABLED
 
 #include <ATen/native/mkldnn/MKLDNNCommon.h>
+#include <ATen/native/mkldnn/RowOccupancy.h>
 #include <ATen/native/mkldnn/Utils.h>
 
 namespace at {
@@ -141,7 +142,29 @@ static Tensor _mkldnn_pool2d(
       algo,
       ideep::prop_kind::forward);
 
-  return new_with_itensor_mkldnn(std::move(y), input.options());
+  Tensor output = new_with_itensor_mkldnn(std::move(y), input.options());
+
+  // An output row only reads the input rows of its window, and a window of
+  // background pixels pools to the background, unless an average counts
+  // the zero padding in.
+  auto occupancy = mkldnn_row_occupancy(input);
+  const bool padded = padding_vec_l[0] > 0 || padding_vec_l[1] > 0 ||
+      padding_vec_r[0] > 0 || padding_vec_r[1] > 0;
+  if (occupancy.defined() &&
+      !(algo == ideep::algorithm::pooling_avg_include_padding && padded &&
+        !occupancy.zero_background())) {
+    MKLDNNRowOccupancy output_occupancy;
+    output_occupancy.rows = dilate_row_mask(
+        occupancy.rows,
+        output_sizes[2],
+        kernel_size_vec[0],
+        stride_vec[0],
+        padding_vec_l[0],
+        dilation_vec[0]);
+    output_occupancy.background = occupancy.background;
+    mkldnn_set_row_occupancy(output, std::move(output_occupancy));
+  }
+  return output;
 }
 
 Tensor mkldnn_max_pool2d(
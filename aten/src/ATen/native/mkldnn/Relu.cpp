@@ -20,21 +20,31 @@ Tensor& mkldnn_relu_(Tensor& input) {
 #else // AT_MKLDNN_EBABLED
 
 #include <ATen/native/mkldnn/MKLDNNCommon.h>
+#include <ATen/native/mkldnn/RowOccupancy.h>
 
 namespace at { namespace native {
 
+static MKLDNNRowOccupancy relu_row_occupancy(const Tensor& input) {
+  return eltwise_row_occupancy(
+      mkldnn_row_occupancy(input), input.dim() == 4 ? input.size(1) : 0,
+      [](const Tensor& background) { return background.clamp_min(0); });
+}
+
 Tensor mkldnn_relu(const Tensor& input) {
   const ideep::tensor& x = itensor_from_mkldnn(input);
   ideep::tensor y;
   ideep::eltwise_forward::compute<AllocForMKLDNN>(
       x, y, ideep::algorithm::eltwise_relu, ideep::prop_kind::forward_training, /*alpha*/ 0.0);
-  return new_with_itensor_mkldnn(std::move(y), input.options());
+  Tensor output = new_with_itensor_mkldnn(std::move(y), input.options());
+  mkldnn_set_row_occupancy(output, relu_row_occupancy(input));
+  return output;
 }
 
 Tensor& mkldnn_relu_(Tensor& input) {
   ideep::tensor& x = itensor_from_mkldnn(input);
   ideep::eltwise_forward::compute<AllocForMKLDNN>(
       x, x, ideep::algorithm::eltwise_relu, ideep::prop_kind::forward_training, /*alpha*/ 0.0);
+  mkldnn_set_row_occupancy(input, relu_row_occupancy(input));
   return input;
 }
 
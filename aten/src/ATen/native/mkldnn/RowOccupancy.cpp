@@ -0,0 +1,311 @@
+#include <ATen/ATen.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/Config.h>
+
+#if !AT_MKLDNN_ENABLED()
+
+namespace at { namespace native {
+
+Tensor& mkldnn_set_row_mask_(Tensor& self, const Tensor& row_mask) {
+  AT_ERROR("mkldnn_set_row_mask_: ATen not compiled with MKLDNN support");
+}
+
+Tensor mkldnn_row_mask(const Tensor& self) {
+  AT_ERROR("mkldnn_row_mask: ATen not compiled with MKLDNN support");
+}
+
+}}
+
+#else // AT_MKLDNN_ENABLED
+
+#include <ATen/Parallel.h>
+#include <ATen/native/mkldnn/RowOccupancy.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace at { namespace native {
+
+namespace {
+// The background as a defined [C] tensor
+Tensor dense_background(const MKLDNNRowOccupancy& occupancy, int64_t channels) {
+  if (occupancy.background.defined()) {
+    return occupancy.background;
+  }
+  return at::zeros({channels}, at::kFloat);
+}
+
+MKLDNNRowOccupancy make_occupancy(Tensor rows, Tensor background) {
+  MKLDNNRowOccupancy occupancy;
+  occupancy.rows = std::move(rows);
+  if (background.ne(0).any().item<bool>()) {
+    occupancy.background = std::move(background);
+  }
+  return occupancy;
+}
+} // namespace
+
+Tensor dilate_row_mask(
+    const Tensor& rows,
+    int64_t output_height,
+    int64_t kernel,
+    int64_t stride,
+    int64_t padding,
+    int64_t dilation) {
+  const int64_t batch = rows.size(0);
+  const int64_t input_height = rows.size(1);
+  auto output = at::zeros({batch, output_height}, rows.options());
+  auto rows_a = rows.accessor<uint8_t, 2>();
+  auto output_a = output.accessor<uint8_t, 2>();
+
+  for (int64_t n = 0; n < batch; ++n) {
+    for (int64_t o = 0; o < output_height; ++o) {
+      for (int64_t i = 0; i < kernel; ++i) {
+        const int64_t h = o * stride - padding + i * dilation;
+        if (h >= 0 && h < input_height && rows_a[n][h]) {
+          output_a[n][o] = 1;
+          break;
+        }
+      }
+    }
+  }
+  return output;
+}
+
+MKLDNNRowOccupancy eltwise_row_occupancy(
+    const MKLDNNRowOccupancy& occupancy,
+    int64_t channels,
+    const std::function<Tensor(const Tensor&)>& fn) {
+  if (!occupancy.defined()) {
+    return MKLDNNRowOccupancy();
+  }
+  return make_occupancy(
+      occupancy.rows, fn(dense_background(occupancy, channels)));
+}
+
+MKLDNNRowOccupancy add_row_occupancy(
+    const MKLDNNRowOccupancy& self,
+    const MKLDNNRowOccupancy& other,
+    int64_t channels,
+    Scalar alpha) {
+  if (!self.defined() || !other.defined()) {
+    return MKLDNNRowOccupancy();
+  }
+  return make_occupancy(
+      self.rows.__or__(other.rows),
+      dense_background(self, channels) +
+          dense_background(other, channels) * alpha);
+}
+
+Tensor dense_to_mkldnn_rows(const Tensor& cpu_tensor, bool blocked) {
+  AT_ASSERTM(
+      cpu_tensor.dim() == 4 && cpu_tensor.is_contiguous() &&
+          cpu_tensor.scalar_type() == ScalarType::Float,
+      "dense_to_mkldnn_rows expects a contiguous 4-D float tensor");
+  const int64_t batch = cpu_tensor.size(0);
+  const int64_t channels = cpu_tensor.size(1);
+  const int64_t height = cpu_tensor.size(2);
+  const int64_t width = cpu_tensor.size(3);
+  const int64_t plane = height * width;
+  constexpr int64_t block = 16;
+  AT_ASSERTM(
+      !blocked || channels % block == 0,
+      "dense_to_mkldnn_rows: nChw16c needs a multiple of 16 channels");
+
+  ideep::tensor dst;
+  dst.init<AllocForMKLDNN>(
+      {{cpu_tensor.sizes().cbegin(), cpu_tensor.sizes().cend()},
+       ideep::tensor::data_type::f32,
+       blocked ? ideep::format::nChw16c : ideep::format::nchw});
+  auto rows = at::empty({batch, height}, cpu_tensor.options().dtype(kByte));
+
+  const float* src_data = cpu_tensor.data<float>();
+  float* dst_data = static_cast<float*>(dst.get_data_handle());
+  uint8_t* rows_data = rows.data<uint8_t>();
+
+  at::parallel_for(0, batch * height, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t nh = begin; nh < end; ++nh) {
+      const int64_t n = nh / height;
+      const int64_t h = nh % height;
+      const float* src_row = src_data + n * channels * plane + h * width;
+      bool occupied = false;
+      for (int64_t c = 0; c < channels && !occupied; ++c) {
+        const float* src_c = src_row + c * plane;
+        occupied = std::any_of(
+            src_c, src_c + width, [](float v) { return v != 0.f; });
+      }
+      rows_data[nh] = occupied;
+
+      if (blocked) {
+        // row h of block cb is a contiguous [width, 16] slab
+        for (int64_t cb = 0; cb < channels / block; ++cb) {
+          float* dst_row = dst_data +
+              ((n * (channels / block) + cb) * height + h) * width * block;
+          if (!occupied) {
+            std::memset(dst_row, 0, width * block * sizeof(float));
+            continue;
+          }
+          for (int64_t c = 0; c < block; ++c) {
+            const float* src_c = src_row + (cb * block + c) * plane;
+            for (int64_t w = 0; w < width; ++w) {
+              dst_row[w * block + c] = src_c[w];
+            }
+          }
+        }
+      } else {
+        for (int64_t c = 0; c < channels; ++c) {
+          float* dst_row = dst_data + n * channels * plane + c * plane + h * width;
+          if (occupied) {
+            std::memcpy(dst_row, src_row + c * plane, width * sizeof(float));
+          } else {
+            std::memset(dst_row, 0, width * sizeof(float));
+          }
+        }
+      }
+    }
+  });
+
+  Tensor mkldnn_tensor = new_with_itensor_mkldnn(std::move(dst), cpu_tensor.options());
+  MKLDNNRowOccupancy occupancy;
+  occupancy.rows = std::move(rows);
+  mkldnn_set_row_occupancy(mkldnn_tensor, std::move(occupancy));
+  return mkldnn_tensor;
+}
+
+namespace {
+template <typename scalar_t>
+void nhwc_to_rows(
+    const scalar_t* src_data,
+    float* dst_data,
+    uint8_t* rows_data,
+    const float* alpha,
+    const float* beta,
+    int64_t batch,
+    int64_t channels,
+    int64_t height,
+    int64_t width,
+    bool blocked) {
+  const int64_t plane = height * width;
+  constexpr int64_t block = 16;
+  at::parallel_for(0, batch * height, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t nh = begin; nh < end; ++nh) {
+      const int64_t n = nh / height;
+      const int64_t h = nh % height;
+      // the pixels of a row are contiguous in channels-last
+      const scalar_t* src_row = src_data + nh * width * channels;
+      const bool occupied = std::any_of(
+          src_row, src_row + width * channels,
+          [](scalar_t v) { return v != scalar_t(0); });
+      rows_data[nh] = occupied;
+
+      for (int64_t c = 0; c < channels; ++c) {
+        float* dst_row;
+        int64_t dst_stride;
+        if (blocked) {
+          dst_row = dst_data +
+              ((n * (channels / block) + c / block) * height + h) * width *
+                  block + c % block;
+          dst_stride = block;
+        } else {
+          dst_row = dst_data + n * channels * plane + c * plane + h * width;
+          dst_stride = 1;
+        }
+        if (!occupied) {
+          for (int64_t w = 0; w < width; ++w) {
+            dst_row[w * dst_stride] = beta[c];
+          }
+          continue;
+        }
+        for (int64_t w = 0; w < width; ++w) {
+          dst_row[w * dst_stride] =
+              static_cast<float>(src_row[w * channels + c]) * alpha[c] + beta[c];
+        }
+      }
+    }
+  });
+}
+} // namespace
+
+Tensor nhwc_to_mkldnn_rows(
+    const Tensor& cpu_tensor,
+    double scale,
+    const Tensor& mean,
+    const Tensor& std,
+    bool blocked) {
+  AT_ASSERTM(
+      cpu_tensor.dim() == 4 && cpu_tensor.is_contiguous() &&
+          (cpu_tensor.scalar_type() == ScalarType::Float ||
+           cpu_tensor.scalar_type() == ScalarType::Byte),
+      "nhwc_to_mkldnn_rows expects a contiguous 4-D float or uint8 tensor");
+  const int64_t batch = cpu_tensor.size(0);
+  const int64_t height = cpu_tensor.size(1);
+  const int64_t width = cpu_tensor.size(2);
+  const int64_t channels = cpu_tensor.size(3);
+  AT_ASSERTM(
+      !blocked || channels % 16 == 0,
+      "nhwc_to_mkldnn_rows: nChw16c needs a multiple of 16 channels");
+
+  // (x * scale - mean) / std == x * alpha + beta
+  auto float_options = cpu_tensor.options().dtype(kFloat);
+  Tensor alpha = at::full({channels}, scale, float_options);
+  Tensor beta = at::zeros({channels}, float_options);
+  if (mean.defined()) {
+    beta = beta - mean.to(kFloat);
+  }
+  if (std.defined()) {
+    alpha = alpha / std.to(kFloat);
+    beta = beta / std.to(kFloat);
+  }
+  alpha = alpha.contiguous();
+  beta = beta.contiguous();
+
+  ideep::tensor dst;
+  dst.init<AllocForMKLDNN>(
+      {{batch, channels, height, width},
+       ideep::tensor::data_type::f32,
+       blocked ? ideep::format::nChw16c : ideep::format::nchw});
+  auto rows = at::empty({batch, height}, cpu_tensor.options().dtype(kByte));
+  float* dst_data = static_cast<float*>(dst.get_data_handle());
+
+  if (cpu_tensor.scalar_type() == ScalarType::Byte) {
+    nhwc_to_rows(
+        cpu_tensor.data<uint8_t>(), dst_data, rows.data<uint8_t>(),
+        alpha.data<float>(), beta.data<float>(),
+        batch, channels, height, width, blocked);
+  } else {
+    nhwc_to_rows(
+        cpu_tensor.data<float>(), dst_data, rows.data<uint8_t>(),
+        alpha.data<float>(), beta.data<float>(),
+        batch, channels, height, width, blocked);
+  }
+
+  Tensor mkldnn_tensor = new_with_itensor_mkldnn(std::move(dst), float_options);
+  mkldnn_set_row_occupancy(mkldnn_tensor, make_occupancy(std::move(rows), beta));
+  return mkldnn_tensor;
+}
+
+Tensor& mkldnn_set_row_mask_(Tensor& self, const Tensor& row_mask) {
+  MKLDNNRowOccupancy occupancy;
+  if (row_mask.defined()) {
+    TORCH_CHECK(self.dim() == 4,
+        "mkldnn_set_row_mask_: expected a 4-D tensor, but got ",
+        self.dim(), "-D");
+    occupancy.rows = mkldnn_row_mask_from(row_mask);
+    TORCH_CHECK(
+        occupancy.rows.size(0) == self.size(0) &&
+            occupancy.rows.size(1) == self.size(2),
+        "mkldnn_set_row_mask_: expected a row mask of shape [",
+        self.size(0), ", ", self.size(2), "], but got ",
+        occupancy.rows.sizes());
+  }
+  mkldnn_set_row_occupancy(self, std::move(occupancy));
+  return self;
+}
+
+Tensor mkldnn_row_mask(const Tensor& self) {
+  return mkldnn_row_occupancy(self).rows;
+}
+
+}}
+
+#endif // AT_MKLDNN_ENABLED
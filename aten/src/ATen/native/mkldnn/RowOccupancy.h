@@ -0,0 +1,60 @@
+#pragma once
+
+#include <ATen/native/mkldnn/MKLDNNCommon.h>
+
+#if AT_MKLDNN_ENABLED()
+
+#include <functional>
+
+namespace at { namespace native {
+
+// Row mask of the output of an op whose output row o reads the input rows
+// o * stride - padding + i * dilation for i in [0, kernel), such as a
+// convolution or a pooling: an output row is occupied if any of its input
+// rows is.
+Tensor dilate_row_mask(
+    const Tensor& rows,
+    int64_t output_height,
+    int64_t kernel,
+    int64_t stride,
+    int64_t padding,
+    int64_t dilation);
+
+// Occupancy after an op that maps every element of channel c by the same
+// function, e.g. ReLU or inference batch norm: the rows are unchanged and
+// `fn` is applied to the [C] background.
+MKLDNNRowOccupancy eltwise_row_occupancy(
+    const MKLDNNRowOccupancy& occupancy,
+    int64_t channels,
+    const std::function<Tensor(const Tensor&)>& fn);
+
+// Occupancy of self + alpha * other: the union of both masks with the
+// summed background. Undefined unless both operands carry one.
+MKLDNNRowOccupancy add_row_occupancy(
+    const MKLDNNRowOccupancy& self,
+    const MKLDNNRowOccupancy& other,
+    int64_t channels,
+    Scalar alpha);
+
+// Converts a contiguous 4-D float tensor to an MKL-DNN tensor in a single
+// pass that copies only the rows (n, h) holding a non-zero in some channel
+// and zero-fills the others, and attaches the row mask it found on the way.
+// `blocked` writes the nChw16c layout of the AVX-512 convolution instead of
+// plain nchw, which needs a multiple of 16 channels.
+Tensor dense_to_mkldnn_rows(const Tensor& cpu_tensor, bool blocked);
+
+// The same for a contiguous channels-last [N, H, W, C] float or uint8 tensor,
+// e.g. decoded video frames, which also get normalized on the way:
+// (x * scale - mean[c]) / std[c], with `mean` and `std` optional [C] tensors.
+// The result has the logical shape [N, C, H, W]. The empty rows hold the
+// normalized zero, which becomes the background of the occupancy.
+Tensor nhwc_to_mkldnn_rows(
+    const Tensor& cpu_tensor,
+    double scale,
+    const Tensor& mean,
+    const Tensor& std,
+    bool blocked);
+
+}}
+
+#endif // AT_MKLDNN_ENABLED
@@ -21,22 +21,32 @@ Tensor& mkldnn_sigmoid_(Tensor& self) {
 #else // AT_MKLDNN_EBABLED
 
 #include <ATen/native/mkldnn/MKLDNNCommon.h>
+#include <ATen/native/mkldnn/RowOccupancy.h>
 
 namespace at {
 namespace native {
 
+static MKLDNNRowOccupancy sigmoid_row_occupancy(const Tensor& self) {
+  return eltwise_row_occupancy(
+      mkldnn_row_occupancy(self), self.dim() == 4 ? self.size(1) : 0,
+      [](const Tensor& background) { return background.sigmoid(); });
+}
+
 Tensor mkldnn_sigmoid(const Tensor& self) {
   ideep::tensor& x = itensor_from_mkldnn(self);
   ideep::tensor y;
   ideep::eltwise_forward::compute(
       x, y, ideep::algorithm::eltwise_logistic, ideep::prop_kind::forward);
-  return new_with_itensor_mkldnn(std::move(y), self.options());
+  Tensor output = new_with_itensor_mkldnn(std::move(y), self.options());
+  mkldnn_set_row_occupancy(output, sigmoid_row_occupancy(self));
+  return output;
 }
 
 Tensor& mkldnn_sigmoid_(Tensor& self) {
   ideep::tensor& x = itensor_from_mkldnn(self);
   ideep::eltwise_forward::compute(
       x, x, ideep::algorithm::eltwise_logistic, ideep::prop_kind::forward);
+  mkldnn_set_row_occupancy(self, sigmoid_row_occupancy(self));
   return self;
 }
 
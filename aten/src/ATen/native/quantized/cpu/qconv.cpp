@@ -1,9 +1,12 @@
 #include <ATen/ATen.h>
+#include <ATen/Parallel.h>
 #include <ATen/core/op_registration/op_registration.h>
 #include <ATen/cpp_custom_type_hack.h>
 #include <ATen/native/quantized/cpu/fbgemm_utils.h>
 #include <ATen/SmallVector.h>
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 
 namespace at {
 namespace native {
@@ -32,6 +35,51 @@ SmallVector<int64_t, 4> convOutputShape(
   return out_shape;
 }
 
+#ifdef USE_FBGEMM
+// Marks the output rows of an NHWC uint8 activation whose receptive field
+// contains a value other than the zero point, i.e. whose real valued input is
+// not all zeros. Returns the number of occupied output rows.
+int64_t occupiedOutputRows(
+    const uint8_t* act_ptr,
+    int N,
+    int H,
+    int W,
+    int C,
+    uint8_t zero_point,
+    int H_out,
+    int kernel_h,
+    int stride_h,
+    int pad_h,
+    std::vector<uint8_t>& out_rows) {
+  const int64_t row_size = static_cast<int64_t>(W) * C;
+  std::vector<uint8_t> in_rows(N * H);
+  at::parallel_for(0, N * H, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t r = begin; r < end; ++r) {
+      const uint8_t* row = act_ptr + r * row_size;
+      in_rows[r] = !std::all_of(
+          row, row + row_size, [&](uint8_t v) { return v == zero_point; });
+    }
+  });
+
+  out_rows.assign(N * H_out, 0);
+  int64_t occupied = 0;
+  for (int n = 0; n < N; ++n) {
+    for (int oh = 0; oh < H_out; ++oh) {
+      int ih_s = std::max(0, oh * stride_h - pad_h);
+      int ih_e = std::min(H, oh * stride_h - pad_h + kernel_h);
+      auto in_begin = in_rows.begin() + n * H;
+      if (std::any_of(in_begin + ih_s, in_begin + ih_e, [](uint8_t v) {
+            return v != 0;
+          })) {
+        out_rows[n * H_out + oh] = 1;
+        ++occupied;
+      }
+    }
+  }
+  return occupied;
+}
+#endif // USE_FBGEMM
+
 /*
  * FBGEMM uses vpmaddubsw instruction to multiply activations (uint8_t) and
  * weights (int8_t).
@@ -175,18 +223,113 @@ class QConv2dInt8 final : public c10::OperatorKernel {
 
     Tensor output = _empty_affine_quantized(
         outShape, device(kCPU).dtype(kQUInt8), output_scale, output_zero_point);
-    auto buffer = at::zeros_like(output, output.options().dtype(at::kInt));
-
-    // Do the GEMM
-    fbgemm::fbgemmPacked(
-        packA,
-        *packB,
-        reinterpret_cast<uint8_t*>(output.data<c10::quint8>()),
-        buffer.data<int32_t>(),
-        K,
-        outputProcObj,
-        0 /* thread_id*/,
-        1 /* num_threads */);
+    uint8_t* output_ptr = reinterpret_cast<uint8_t*>(output.data<c10::quint8>());
+
+    // Output rows whose receptive field only holds the activation zero point
+    // (real value 0, as are the padded borders that im2col fills with the
+    // zero point) reduce to the requantized bias. Those rows are filled
+    // directly and the GEMM only runs over the runs of occupied rows.
+    int H_out = outShape[1];
+    int W_out = outShape[2];
+    std::vector<uint8_t> out_rows;
+    int64_t occupied = occupiedOutputRows(
+        act_ptr, N, H, W, C, act_zero_point, H_out, kernel_h, stride_h, pad_l,
+        out_rows);
+
+    if (occupied == static_cast<int64_t>(N) * H_out) {
+      auto buffer = at::zeros_like(output, output.options().dtype(at::kInt));
+
+      // Do the GEMM
+      fbgemm::fbgemmPacked(
+          packA,
+          *packB,
+          output_ptr,
+          buffer.data<int32_t>(),
+          K,
+          outputProcObj,
+          0 /* thread_id*/,
+          1 /* num_threads */);
+
+      return output;
+    }
+
+    std::vector<uint8_t> empty_row(K);
+    for (int k = 0; k < K; ++k) {
+      float raw = bias_ptr ? bias_ptr[k] * output_multiplier_float : 0.f;
+      int32_t v = std::nearbyint(raw) + output_zero_point;
+      empty_row[k] = std::min<int32_t>(255, std::max<int32_t>(0, v));
+    }
+
+    std::vector<int32_t> buffer;
+    for (int n = 0; n < N; ++n) {
+      const uint8_t* img_rows = out_rows.data() + n * H_out;
+      for (int oh_s = 0; oh_s < H_out;) {
+        uint8_t* out_row =
+            output_ptr + (static_cast<int64_t>(n) * H_out + oh_s) * W_out * K;
+        if (!img_rows[oh_s]) {
+          for (int ow = 0; ow < W_out; ++ow) {
+            std::memcpy(out_row + ow * K, empty_row.data(), K);
+          }
+          ++oh_s;
+          continue;
+        }
+        int oh_e = oh_s;
+        while (oh_e < H_out && img_rows[oh_e]) {
+          ++oh_e;
+        }
+
+        // Convolve the input rows under [oh_s, oh_e) on their own, moving
+        // the part of the window that falls outside the image into the
+        // top and bottom padding.
+        int ih_s = oh_s * stride_h - pad_l;
+        int ih_e = (oh_e - 1) * stride_h - pad_l + kernel_h;
+        int run_pad_t = std::max(0, -ih_s);
+        int run_pad_b = std::max(0, ih_e - H);
+        ih_s = std::max(0, ih_s);
+        ih_e = std::min(H, ih_e);
+
+        fbgemm::conv_param_t<> run_p(
+            1,
+            C,
+            K,
+            {ih_e - ih_s, W},
+            groups,
+            {kernel_h, kernel_w},
+            {stride_h, stride_w},
+            {run_pad_t, pad_t, run_pad_b, pad_t});
+
+        fbgemm::PackAWithIm2Col<uint8_t> runA(
+            run_p,
+            act_ptr + (static_cast<int64_t>(n) * H + ih_s) * W * C,
+            nullptr,
+            act_zero_point,
+            row_offset_buf.data());
+
+        fbgemm::ReQuantizeOutput<false> runProcObj(
+            NoOpObj,
+            &output_multiplier_float,
+            output_zero_point,
+            act_zero_point,
+            &weight_zero_point_int32,
+            runA.getRowOffsetBuffer(),
+            col_offsets.data(),
+            bias_ptr,
+            K,
+            groups);
+
+        buffer.assign(static_cast<size_t>(oh_e - oh_s) * W_out * K, 0);
+        fbgemm::fbgemmPacked(
+            runA,
+            *packB,
+            out_row,
+            buffer.data(),
+            K,
+            runProcObj,
+            0 /* thread_id*/,
+            1 /* num_threads */);
+        oh_s = oh_e;
+      }
+    }
 
     return output;
   }
@@ -10,6 +10,9 @@
 
 #include <TH/THBlasUtils.h>
 
+#include <algorithm>
+#include <numeric>
+
 namespace at { namespace native {
 
 using namespace at::sparse;
@@ -347,6 +350,87 @@ SparseTensor& copy_sparse_(SparseTensor& self, const SparseTensor& src, bool non
   return self._coalesced_(src.is_coalesced());
 }
 
+namespace {
+
+// Splits [0, n) into at most get_num_threads() chunks of at least GRAIN_SIZE
+// elements, so that passes over the same chunks see the same boundaries.
+int64_t coalesce_num_chunks(int64_t n) {
+  return std::max<int64_t>(
+      1, std::min<int64_t>(at::get_num_threads(), n / at::internal::GRAIN_SIZE));
+}
+
+// Stable LSD radix sort of the flattened indices `keys[0, n)`, all in
+// [0, max_key], by 8-bit digits. Returns the sorted keys and the
+// permutation that sorts them. Every pass histograms the digits per chunk,
+// turns the histograms into per-chunk output offsets and scatters the chunks
+// in parallel; passes whose digit is the same for all keys are skipped.
+std::tuple<LongTensor, LongTensor> radix_sort_indices(
+    const LongTensor& keys, int64_t max_key) {
+  constexpr int64_t radix_bits = 8;
+  constexpr int64_t radix = 1 << radix_bits;
+  const int64_t n = keys.numel();
+  const int64_t nchunks = coalesce_num_chunks(n);
+  const int64_t chunk_size = (n + nchunks - 1) / nchunks;
+
+  LongTensor keys_a = keys.clone();
+  LongTensor perm_a = at::arange(n, keys.options());
+  LongTensor keys_b = at::empty_like(keys_a);
+  LongTensor perm_b = at::empty_like(perm_a);
+  std::vector<int64_t> offsets(nchunks * radix);
+
+  for (int64_t shift = 0; shift < 64 && (max_key >> shift) > 0;
+       shift += radix_bits) {
+    const int64_t* src_keys = keys_a.data<int64_t>();
+    const int64_t* src_perm = perm_a.data<int64_t>();
+    int64_t* dst_keys = keys_b.data<int64_t>();
+    int64_t* dst_perm = perm_b.data<int64_t>();
+    auto digit = [shift](int64_t key) { return (key >> shift) & (radix - 1); };
+
+    std::fill(offsets.begin(), offsets.end(), 0);
+    at::parallel_for(0, nchunks, 1, [&](int64_t c_begin, int64_t c_end) {
+      for (int64_t c = c_begin; c < c_end; c++) {
+        int64_t* hist = offsets.data() + c * radix;
+        for (int64_t j = c * chunk_size; j < std::min(n, (c + 1) * chunk_size); j++) {
+          hist[digit(src_keys[j])]++;
+        }
+      }
+    });
+
+    // exclusive scan in (digit, chunk) order
+    int64_t total = 0;
+    bool single_digit = false;
+    for (int64_t d = 0; d < radix; d++) {
+      int64_t digit_count = 0;
+      for (int64_t c = 0; c < nchunks; c++) {
+        int64_t count = offsets[c * radix + d];
+        offsets[c * radix + d] = total;
+        total += count;
+        digit_count += count;
+      }
+      single_digit = single_digit || digit_count == n;
+    }
+    if (single_digit) {
+      continue;
+    }
+
+    at::parallel_for(0, nchunks, 1, [&](int64_t c_begin, int64_t c_end) {
+      for (int64_t c = c_begin; c < c_end; c++) {
+        int64_t* pos = offsets.data() + c * radix;
+        for (int64_t j = c * chunk_size; j < std::min(n, (c + 1) * chunk_size); j++) {
+          int64_t out = pos[digit(src_keys[j])]++;
+          dst_keys[out] = src_keys[j];
+          dst_perm[out] = src_perm[j];
+        }
+      }
+    });
+    std::swap(keys_a, keys_b);
+    std::swap(perm_a, perm_b);
+  }
+  return std::make_tuple(keys_a, perm_a);
+}
+
+} // namespace
+
 SparseTensor coalesce_sparse_cpu(const SparseTensor& self) {
   AT_ASSERT(self.defined());
   AT_ASSERT(!self.is_variable());  // TODO: change this to check `.requires_grad()` and `GradMode::is_enabled()` when Variable and Tensor are merged
@@ -369,7 +453,7 @@ SparseTensor coalesce_sparse_cpu(const SparseTensor& self) {
   int64_t dense_dim = self.dense_dim();
   int64_t nnz = self._nnz();
 
-  LongTensor indices_scalar = flatten_indices(indices, self.sizes());
+  LongTensor indices_scalar = flatten_indices(indices, self.sizes()).contiguous();
 
   SparseTensor dst = new_sparse(self.options());
   get_sparse_impl(dst)->resize_(sparse_dim, dense_dim, self.sizes());
@@ -378,44 +462,120 @@ SparseTensor coalesce_sparse_cpu(const SparseTensor& self) {
   Tensor newValues = at::empty(values.sizes(), values.options());
   alias_into_sparse(dst, newIndices, newValues);
 
+  // Indices that come out of an op in order (e.g. an embedding gradient with
+  // sorted input) need no sort at all. Otherwise the flattened indices are
+  // bounded by the product of the sparse sizes, so a radix sort over just
+  // the bits of the largest one beats a comparison sort.
+  const int64_t* keys = indices_scalar.data<int64_t>();
+  bool sorted = true;
+  int64_t min_key = keys[0];
+  int64_t max_key = keys[0];
+  {
+    const int64_t nchunks = coalesce_num_chunks(nnz);
+    const int64_t chunk_size = (nnz + nchunks - 1) / nchunks;
+    std::vector<uint8_t> chunk_sorted(nchunks, 1);
+    std::vector<int64_t> chunk_min(nchunks, keys[0]), chunk_max(nchunks, keys[0]);
+    at::parallel_for(0, nchunks, 1, [&](int64_t c_begin, int64_t c_end) {
+      for (int64_t c = c_begin; c < c_end; c++) {
+        const int64_t begin = c * chunk_size;
+        const int64_t end = std::min(nnz, (c + 1) * chunk_size);
+        int64_t lo = keys[begin], hi = keys[begin];
+        bool in_order = begin == 0 || keys[begin - 1] <= keys[begin];
+        for (int64_t j = begin + 1; j < end; j++) {
+          in_order = in_order && keys[j - 1] <= keys[j];
+          lo = std::min(lo, keys[j]);
+          hi = std::max(hi, keys[j]);
+        }
+        chunk_sorted[c] = in_order;
+        chunk_min[c] = lo;
+        chunk_max[c] = hi;
+      }
+    });
+    for (int64_t c = 0; c < nchunks; c++) {
+      sorted = sorted && chunk_sorted[c];
+      min_key = std::min(min_key, chunk_min[c]);
+      max_key = std::max(max_key, chunk_max[c]);
+    }
+  }
+
   LongTensor indicesBuffer;
   LongTensor indicesPermutation;
-  std::tie(indicesBuffer, indicesPermutation) = indices_scalar.sort(0);
+  if (sorted) {
+    indicesBuffer = indices_scalar;
+    indicesPermutation = at::arange(nnz, indices.options());
+  } else if (min_key >= 0) {
+    std::tie(indicesBuffer, indicesPermutation) =
+        radix_sort_indices(indices_scalar, max_key);
+  } else {
+    std::tie(indicesBuffer, indicesPermutation) = indices_scalar.sort(0);
+  }
   // NB: The accessor accesses here rely on self._nnz() > 0 (tested earlier in this function)
   auto newIndicesAccessor = newIndices.accessor<int64_t, 2>();
   auto indicesAccessor = indices.accessor<int64_t, 2>();
-  auto indicesPermutationAccessor = indicesPermutation.accessor<int64_t, 1>();
-  auto indicesBufferAccessor = indicesBuffer.accessor<int64_t, 1>();
+  const int64_t* perm = indicesPermutation.data<int64_t>();
+  const int64_t* sorted_keys = indicesBuffer.data<int64_t>();
+
+  // Segmented reduction: every chunk counts the segments (runs of equal
+  // keys) that start in it, which gives it the output slot of its first
+  // one, and then reduces those segments, reading past its end if the last
+  // one continues into the next chunk.
+  const int64_t nchunks = coalesce_num_chunks(nnz);
+  const int64_t chunk_size = (nnz + nchunks - 1) / nchunks;
+  auto is_head = [&](int64_t j) {
+    return j == 0 || sorted_keys[j] != sorted_keys[j - 1];
+  };
+  std::vector<int64_t> chunk_out(nchunks + 1, 0);
+  at::parallel_for(0, nchunks, 1, [&](int64_t c_begin, int64_t c_end) {
+    for (int64_t c = c_begin; c < c_end; c++) {
+      int64_t heads = 0;
+      for (int64_t j = c * chunk_size; j < std::min(nnz, (c + 1) * chunk_size); j++) {
+        heads += is_head(j);
+      }
+      chunk_out[c + 1] = heads;
+    }
+  });
+  std::partial_sum(chunk_out.begin(), chunk_out.end(), chunk_out.begin());
+  const int64_t newNnz = chunk_out[nchunks];
 
-  int64_t i = -1;
   AT_DISPATCH_ALL_TYPES(
       values.scalar_type(), "coalesce", [&] {
-        int64_t prev = -1;
         int64_t blockSize = values.stride(0);
         scalar_t* values_ptr = values.data<scalar_t>();
         scalar_t* newValues_ptr = newValues.data<scalar_t>();
-        for (int64_t j = 0; j < nnz; j++) {
-          int64_t pos = indicesPermutationAccessor[j];
-          int64_t curr = indicesBufferAccessor[j];
-          if (curr == prev) {
-            if (values.numel() > 0) {  // if values is an empty tensor, there are no elements to copy
-              THBlas_axpy<scalar_t>(blockSize, 1, values_ptr + pos * blockSize, 1, newValues_ptr + i * blockSize, 1);
+        at::parallel_for(0, nchunks, 1, [&](int64_t c_begin, int64_t c_end) {
+          for (int64_t c = c_begin; c < c_end; c++) {
+            int64_t i = chunk_out[c] - 1;
+            const int64_t end = std::min(nnz, (c + 1) * chunk_size);
+            int64_t j = c * chunk_size;
+            // the tail of a segment from the previous chunk belongs to it
+            while (j < end && !is_head(j)) {
+              j++;
             }
-          } else {
-            ++i;
-            for (int64_t d = 0; d < sparse_dim; d++) {
-              newIndicesAccessor[d][i] = indicesAccessor[d][pos];
+            if (j == end) {
+              continue;
             }
-            if (values.numel() > 0) {  // if values is an empty tensor, there are no elements to copy
-              THBlas_copy<scalar_t>(blockSize, values_ptr + pos * blockSize, 1, newValues_ptr + i * blockSize, 1);
+            for (; j < nnz && (j < end || !is_head(j)); j++) {
+              int64_t pos = perm[j];
+              if (!is_head(j)) {
+                if (values.numel() > 0) {  // if values is an empty tensor, there are no elements to copy
+                  THBlas_axpy<scalar_t>(blockSize, 1, values_ptr + pos * blockSize, 1, newValues_ptr + i * blockSize, 1);
+                }
+              } else {
+                ++i;
+                for (int64_t d = 0; d < sparse_dim; d++) {
+                  newIndicesAccessor[d][i] = indicesAccessor[d][pos];
+                }
+                if (values.numel() > 0) {  // if values is an empty tensor, there are no elements to copy
+                  THBlas_copy<scalar_t>(blockSize, values_ptr + pos * blockSize, 1, newValues_ptr + i * blockSize, 1);
+                }
+              }
             }
           }
-          prev = curr;
-        }
+        });
     });
 
   dst._coalesced_(true);
-  get_sparse_impl(dst)->set_nnz_and_narrow(i + 1);
+  get_sparse_impl(dst)->set_nnz_and_narrow(newNnz);
 
   return dst;
 }
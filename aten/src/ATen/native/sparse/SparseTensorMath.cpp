@@ -6,9 +6,13 @@
 #include <ATen/InitialTensorOptions.h>
 #include <ATen/SparseTensorUtils.h>
 #include <ATen/WrapDimUtilsMulti.h>
+#include <ATen/native/cpu/SparseDenseMMKernel.h>
 
 #include <TH/THBlasUtils.h>
 
+#include <algorithm>
+#include <numeric>
+
 namespace at { namespace native {
 
 using namespace at::sparse;
@@ -88,30 +92,109 @@ SparseTensor& mul_out_sparse_scalar(SparseTensor& r, const SparseTensor& t, Scal
 }
 
 // --------------------------------------------------------------------
-// log1p(SparseTensor)
+// zero-preserving unary ops on SparseTensor
 // --------------------------------------------------------------------
 
-// TODO: add in-place variant
-
-SparseTensor& log1p_out_sparse(SparseTensor& r, const SparseTensor& t) {
+// An elementwise function with f(0) == 0 maps a sparse tensor to one with
+// the same indices, so it is applied to the values only, by the dense out=
+// kernel `values_out(r_values, t_values)`. The input is coalesced first, as
+// f(a + b) != f(a) + f(b) in general; this is also why in-place ops need a
+// coalesced tensor.
+template <typename Op>
+SparseTensor& unary_op_out_sparse(SparseTensor& r, const SparseTensor& t_, const char* name, const Op& values_out) {
   AT_ASSERT(r.is_sparse());
-  AT_ASSERT(t.is_sparse());
+  AT_ASSERT(t_.is_sparse());
 
-  if (is_same_tensor(r, t)) {
-    // don't have in-place log1p for uncoalesced input because coalesce() is not in-place
-    TORCH_CHECK(
-      r.is_coalesced(), "log1p: in-place on uncoalesced tensors is not supported yet!");
+  if (is_same_tensor(r, t_)) {
+    // don't have in-place ops for uncoalesced input because coalesce() is not in-place
+    TORCH_CHECK(r.is_coalesced(), name, ": in-place on uncoalesced tensors is not supported yet!");
+    Tensor r_values = r._values();
+    values_out(r_values, r_values);
+    return r;
   }
-  else {
-    copy_sparse_to_sparse_(r, t.coalesce());
+
+  SparseTensor t = t_.coalesce();
+  r.resize_as_(t);
+  auto indices = r._indices();
+  indices.resize_as_(t._indices());
+  indices.copy_(t._indices());
+  Tensor r_values = r._values(); // Sigh... needed because the out= kernels take Tensor&
+  values_out(r_values, t._values());
+  get_sparse_impl(r)->set_nnz_and_narrow(t._nnz());
+  return r._coalesced_(true);
+}
+
+#define IMPLEMENT_SPARSE_UNARY_OP(op)                                          \
+  SparseTensor& op##_out_sparse(SparseTensor& r, const SparseTensor& t) {      \
+    return unary_op_out_sparse(r, t, #op,                                      \
+        [](Tensor& r_values, const Tensor& t_values) {                         \
+          at::op##_out(r_values, t_values);                                    \
+        });                                                                    \
+  }                                                                            \
+  SparseTensor& op##_sparse_(SparseTensor& t) {                                \
+    return op##_out_sparse(t, t);                                              \
   }
-  r._values().log1p_();
+
+IMPLEMENT_SPARSE_UNARY_OP(abs)
+IMPLEMENT_SPARSE_UNARY_OP(asin)
+IMPLEMENT_SPARSE_UNARY_OP(atan)
+IMPLEMENT_SPARSE_UNARY_OP(ceil)
+IMPLEMENT_SPARSE_UNARY_OP(erf)
+IMPLEMENT_SPARSE_UNARY_OP(erfinv)
+IMPLEMENT_SPARSE_UNARY_OP(expm1)
+IMPLEMENT_SPARSE_UNARY_OP(floor)
+IMPLEMENT_SPARSE_UNARY_OP(frac)
+IMPLEMENT_SPARSE_UNARY_OP(log1p)
+IMPLEMENT_SPARSE_UNARY_OP(neg)
+IMPLEMENT_SPARSE_UNARY_OP(round)
+IMPLEMENT_SPARSE_UNARY_OP(sign)
+IMPLEMENT_SPARSE_UNARY_OP(sin)
+IMPLEMENT_SPARSE_UNARY_OP(sinh)
+IMPLEMENT_SPARSE_UNARY_OP(sqrt)
+IMPLEMENT_SPARSE_UNARY_OP(tan)
+IMPLEMENT_SPARSE_UNARY_OP(tanh)
+IMPLEMENT_SPARSE_UNARY_OP(trunc)
+
+SparseTensor sign_sparse(const SparseTensor& t) {
+  SparseTensor r = at::empty({0}, t.options());
+  sign_out_sparse(r, t);
+  return r;
+}
+
+SparseTensor erfinv_sparse(const SparseTensor& t) {
+  SparseTensor r = at::empty({0}, t.options());
+  erfinv_out_sparse(r, t);
+  return r;
+}
+
+SparseTensor& relu_out_sparse(SparseTensor& r, const SparseTensor& t) {
+  return unary_op_out_sparse(r, t, "relu",
+      [](Tensor& r_values, const Tensor& t_values) {
+        at::threshold_out(r_values, t_values, 0, 0);
+      });
+}
+
+SparseTensor relu_sparse(const SparseTensor& t) {
+  SparseTensor r = at::empty({0}, t.options());
+  relu_out_sparse(r, t);
   return r;
 }
 
-SparseTensor& log1p_sparse_(SparseTensor& t) {
-  TORCH_CHECK(t.is_coalesced(), "log1p: in-place on uncoalesced tensors is not supported yet!");
-  return log1p_out_sparse(t, t);
+SparseTensor& relu_sparse_(SparseTensor& t) {
+  return relu_out_sparse(t, t);
+}
+
+SparseTensor& clamp_out_sparse(SparseTensor& r, const SparseTensor& t, optional<Scalar> min, optional<Scalar> max) {
+  TORCH_CHECK((!min || min->toDouble() <= 0) && (!max || max->toDouble() >= 0),
+      "clamp: the range must contain zero on sparse tensor; otherwise it would make the result tensor dense");
+  return unary_op_out_sparse(r, t, "clamp",
+      [&](Tensor& r_values, const Tensor& t_values) {
+        at::clamp_out(r_values, t_values, min, max);
+      });
+}
+
+SparseTensor& clamp_sparse_(SparseTensor& t, optional<Scalar> min, optional<Scalar> max) {
+  return clamp_out_sparse(t, t, min, max);
 }
 
 // --------------------------------------------------------------------
@@ -187,6 +270,136 @@ Tensor norm_sparse(const SparseTensor& self, Scalar value) {
 // add(SparseTensor, SparseTensor, Scalar)  [broadcasts]
 // --------------------------------------------------------------------
 
+// Parallel merge of two coalesced sparse tensors with contiguous values.
+// The merged sequence of t_nnz + s_nnz entries is cut into equal parts, and
+// the co-ranks of every cut, the number of entries of t and of src before
+// it, are found by a binary search along its diagonal (the merge path). An
+// index present in both inputs is always kept in one part, so the parts
+// merge independently: a first pass counts the entries of every part, and a
+// second one writes them at the prefix sums of the counts.
+template <typename scalar_t>
+void add_out_sparse_merge_cpu(SparseTensor& r, const LongTensor& t_indices_, const Tensor& t_values, const LongTensor& src_indices_, const Tensor& s_values, Scalar value) {
+  const int64_t sparse_dim = t_indices_.size(0);
+  const int64_t t_nnz = t_indices_.size(1), s_nnz = src_indices_.size(1);
+  const int64_t max_nnz = t_nnz + s_nnz;
+  const int64_t blockSize = s_values.numel() / s_nnz;
+
+  LongTensor t_indices = t_indices_.contiguous();
+  LongTensor src_indices = src_indices_.contiguous();
+  const int64_t* t_indices_ptr = t_indices.data<int64_t>();
+  const int64_t* src_indices_ptr = src_indices.data<int64_t>();
+
+  // < 0 if the index of entry i of t comes before that of entry j of src
+  auto compare = [&](int64_t i, int64_t j) -> int64_t {
+    for (int64_t d = 0; d < sparse_dim; d++) {
+      int64_t diff = t_indices_ptr[d * t_nnz + i] - src_indices_ptr[d * s_nnz + j];
+      if (diff != 0) {
+        return diff;
+      }
+    }
+    return 0;
+  };
+
+  // co-ranks of the first `diag` merged entries, taking t first on ties
+  auto co_rank = [&](int64_t diag) -> std::pair<int64_t, int64_t> {
+    int64_t lo = std::max<int64_t>(0, diag - s_nnz);
+    int64_t hi = std::min<int64_t>(diag, t_nnz);
+    while (lo < hi) {
+      int64_t mid = lo + (hi - lo) / 2;
+      if (compare(mid, diag - 1 - mid) > 0) {
+        hi = mid;
+      } else {
+        lo = mid + 1;
+      }
+    }
+    int64_t j = diag - lo;
+    // keep the src entry matching the last t entry in this part
+    if (lo > 0 && j < s_nnz && compare(lo - 1, j) == 0) {
+      j++;
+    }
+    return {lo, j};
+  };
+
+  const int64_t nparts = std::max<int64_t>(1, std::min<int64_t>(
+      at::get_num_threads(), max_nnz * std::max<int64_t>(blockSize, 1) / at::internal::GRAIN_SIZE));
+  std::vector<std::pair<int64_t, int64_t>> cuts(nparts + 1);
+  std::vector<int64_t> offsets(nparts + 1, 0);
+  at::parallel_for(0, nparts + 1, 1, [&](int64_t start, int64_t end) {
+    for (int64_t p = start; p < end; p++) {
+      cuts[p] = co_rank(max_nnz * p / nparts);
+    }
+  });
+
+  at::parallel_for(0, nparts, 1, [&](int64_t start, int64_t end) {
+    for (int64_t p = start; p < end; p++) {
+      int64_t t_i = cuts[p].first, s_i = cuts[p].second;
+      const int64_t t_end = cuts[p + 1].first, s_end = cuts[p + 1].second;
+      int64_t count = 0;
+      while (t_i < t_end && s_i < s_end) {
+        int64_t cmp = compare(t_i, s_i);
+        t_i += cmp <= 0;
+        s_i += cmp >= 0;
+        count++;
+      }
+      offsets[p + 1] = count + (t_end - t_i) + (s_end - s_i);
+    }
+  });
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+  const int64_t r_nnz = offsets[nparts];
+
+  LongTensor r_indices = at::empty({sparse_dim, r_nnz}, t_indices.options());
+  Tensor r_values = new_values_with_size_of(s_values, r_nnz);
+  int64_t* r_indices_ptr = r_indices.data<int64_t>();
+  const scalar_t* t_values_ptr = t_values.data<scalar_t>();
+  const scalar_t* s_values_ptr = s_values.data<scalar_t>();
+  scalar_t* r_values_ptr = r_values.data<scalar_t>();
+  scalar_t cast_value = value.to<scalar_t>();
+
+  at::parallel_for(0, nparts, 1, [&](int64_t start, int64_t end) {
+    for (int64_t p = start; p < end; p++) {
+      int64_t t_i = cuts[p].first, s_i = cuts[p].second;
+      const int64_t t_end = cuts[p + 1].first, s_end = cuts[p + 1].second;
+      for (int64_t r_i = offsets[p]; r_i < offsets[p + 1]; r_i++) {
+        int64_t cmp;
+        if (t_i >= t_end) {
+          cmp = 1;
+        } else if (s_i >= s_end) {
+          cmp = -1;
+        } else {
+          cmp = compare(t_i, s_i);
+        }
+        scalar_t* r_block = r_values_ptr + r_i * blockSize;
+        const scalar_t* t_block = t_values_ptr + t_i * blockSize;
+        const scalar_t* s_block = s_values_ptr + s_i * blockSize;
+        if (cmp <= 0) {
+          for (int64_t d = 0; d < sparse_dim; d++) {
+            r_indices_ptr[d * r_nnz + r_i] = t_indices_ptr[d * t_nnz + t_i];
+          }
+        } else {
+          for (int64_t d = 0; d < sparse_dim; d++) {
+            r_indices_ptr[d * r_nnz + r_i] = src_indices_ptr[d * s_nnz + s_i];
+          }
+        }
+        if (cmp < 0) {
+          std::copy(t_block, t_block + blockSize, r_block);
+        } else if (cmp > 0) {
+          for (int64_t k = 0; k < blockSize; k++) {
+            r_block[k] = cast_value * s_block[k];
+          }
+        } else {
+          for (int64_t k = 0; k < blockSize; k++) {
+            r_block[k] = t_block[k] + cast_value * s_block[k];
+          }
+        }
+        t_i += cmp <= 0;
+        s_i += cmp >= 0;
+      }
+    }
+  });
+
+  get_sparse_impl(r)->set_indices_and_values_unsafe(r_indices, r_values);
+}
+
 SparseTensor& add_out_sparse_cpu(SparseTensor& r, const SparseTensor& t, const SparseTensor& src, Scalar value) {
   AT_ASSERT(r.is_sparse());
   AT_ASSERT(t.is_sparse());
@@ -215,7 +428,14 @@ SparseTensor& add_out_sparse_cpu(SparseTensor& r, const SparseTensor& t, const S
   Tensor s_values = src._values();
   r.resize_as_(src);
 
-  if (s_values.is_contiguous() && t_values.is_contiguous()) {
+  if (s_values.is_contiguous() && t_values.is_contiguous() && t_coalesced && s_coalesced) {
+    AT_DISPATCH_ALL_TYPES(
+        t_values.scalar_type(), "cadd_sparse", [&] {
+          add_out_sparse_merge_cpu<scalar_t>(r, t_indices, t_values, src_indices, s_values, value);
+        }
+    );
+    return r._coalesced_(true);
+  } else if (s_values.is_contiguous() && t_values.is_contiguous()) {
     LongTensor r_indices = at::empty({sparse_dim, max_nnz}, t_indices.options());
     Tensor r_values = new_values_with_size_of(s_values, max_nnz).zero_();
     get_sparse_impl(r)->set_indices_and_values_unsafe(r_indices, r_values);
@@ -479,11 +699,7 @@ SparseTensor& mul_out_sparse_cpu(SparseTensor& r, const Tensor& t_, const Tensor
 // --------------------------------------------------------------------
 
 template <typename scalar_t>
-void s_addmm_out_sparse_dense_worker(int64_t nnz, int64_t dim_i, int64_t dim_j, int64_t dim_k, Tensor& r, Scalar beta, const Tensor& t, Scalar alpha, const Tensor& indices, const Tensor& values, const Tensor& dense) {
-  int64_t i;
-
-  // r_ = alpha * sparse * dense
-  scalar_t cast_alpha = alpha.to<scalar_t>();
+void s_addmm_out_sparse_dense_scale(Tensor& r, Scalar beta, const Tensor& t) {
   scalar_t cast_beta = beta.to<scalar_t>();
   if (cast_beta == 0) {
     r.zero_();
@@ -494,35 +710,7 @@ void s_addmm_out_sparse_dense_worker(int64_t nnz, int64_t dim_i, int64_t dim_j,
   } else {
     at::mul_out(r, t, scalar_to_tensor(beta));
   }
-
-  auto indices_accessor = indices.accessor<int64_t, 2>();
-
-  auto values_accessor = values.accessor<scalar_t, 1>();
-  scalar_t* dense_ptr = dense.data<scalar_t>();
-  scalar_t* r_ptr = r.data<scalar_t>();
-
-  int64_t dense_stride0 = dense.stride(0);
-  int64_t dense_stride1 = dense.stride(1);
-  int64_t r_stride0 = r.stride(0);
-  int64_t r_stride1 = r.stride(1);
-  for (i = 0; i < nnz; i++) {
-    scalar_t val = values_accessor[i];
-    int64_t row = indices_accessor[0][i];
-    int64_t col = indices_accessor[1][i];
-    if (col >= 0 && col < dim_j && row >= 0 && row < dim_i) {
-      THBlas_axpy<scalar_t>(dim_k,
-            cast_alpha * val,
-            dense_ptr + col * dense_stride0, dense_stride1,
-            r_ptr + row * r_stride0, r_stride1);
-    } else {
-      if (col < 0 || col >= dim_j) {
-        AT_ERROR("addmm: index out of column bound: ", col, " not between 1 and ", dim_j);
-      } else {
-        AT_ERROR("addmm: index out of row bound: ", row, " not between 1 and ", dim_i);
-      }
-    }
-  }
-};
+}
 
 Tensor& s_addmm_out_sparse_dense_cpu(
     Tensor& r,
@@ -566,11 +754,32 @@ Tensor& s_addmm_out_sparse_dense_cpu(
   LongTensor indices = sparse_._indices();
   Tensor values      = sparse_._values();
 
+  // A coalesced matrix is already in CSR order: group the products by row
+  if (sparse_.is_coalesced()) {
+    LongTensor row_indices = indices.select(0, 0).contiguous();
+    const int64_t first_row = row_indices.data<int64_t>()[0];
+    const int64_t last_row = row_indices.data<int64_t>()[nnz - 1];
+    TORCH_CHECK(first_row >= 0 && last_row < dim_i,
+        "addmm: index out of row bound: ", first_row < 0 ? first_row : last_row,
+        " not between 1 and ", dim_i);
+    LongTensor csr = _to_csr(row_indices.data<int64_t>(), dim_i, nnz);
+    LongTensor col_indices = indices.select(0, 1).contiguous();
+    Tensor values_contig = values.contiguous();
+    AT_DISPATCH_ALL_TYPES(
+        values.scalar_type(), "addmm_sparse_dense", [&] {
+          s_addmm_out_sparse_dense_scale<scalar_t>(r, beta, t);
+        }
+    );
+    addmm_sparse_dense_csr_stub(kCPU, r, alpha, csr, col_indices, values_contig, dense);
+    return r;
+  }
+
   AT_DISPATCH_ALL_TYPES(
       values.scalar_type(), "addmm_sparse_dense", [&] {
-        s_addmm_out_sparse_dense_worker<scalar_t>(nnz, dim_i, dim_j, dim_k, r, beta, t, alpha, indices, values, dense);
+        s_addmm_out_sparse_dense_scale<scalar_t>(r, beta, t);
       }
   );
+  addmm_sparse_dense_coo_stub(kCPU, r, alpha, indices, values, dense);
 
   return r;
 
@@ -627,6 +836,20 @@ SparseTensor& _sparse_mm_out(
   return at::addmm_out(result, t, sparse, dense, 0, 1);
 }
 
+// --------------------------------------------------------------------
+// mv(S, d) -> d
+//
+// SpMV as the SpMM of a single column
+// --------------------------------------------------------------------
+
+Tensor mv_sparse(const SparseTensor& self, const Tensor& vec) {
+  TORCH_CHECK(self.sparse_dim() == 2 && self.dense_dim() == 0,
+      "mv: expected a sparse matrix, but got a sparse tensor with ",
+      self.sparse_dim(), " sparse and ", self.dense_dim(), " dense dimensions");
+  TORCH_CHECK(vec.dim() == 1, "mv: expected a vector, but got ", vec.dim(), "D tensor");
+  return at::_sparse_mm(self, vec.unsqueeze(1)).squeeze(1);
+}
+
 // --------------------------------------------------------------------
 // hspmm(SparseTensor mat1, Tensor mat2)
 // --------------------------------------------------------------------
@@ -1088,4 +1311,7 @@ Tensor _sparse_sum_backward_cpu(const Tensor& grad_, const SparseTensor& input_,
   }
 }
 
+DEFINE_DISPATCH(addmm_sparse_dense_csr_stub);
+DEFINE_DISPATCH(addmm_sparse_dense_coo_stub);
+
 }} // namespace at::native
@@ -4,6 +4,7 @@
 
 #include <ATen/div_rtn.h>
 #include <ATen/Parallel.h>
+#include <ATen/core/grad_mode.h>
 
 static inline void THNN_(SpatialConvolutionMM_shapeCheck)(
         THTensor *input, THTensor *gradOutput,
@@ -94,6 +95,83 @@ static THTensor* THNN_(newViewWeightMM2d)(THTensor *weight) {
   return weight;
 }
 
+/* Lists the output rows whose receptive field covers at least one input row
+ * that is not all zero, and returns their number. The other output rows
+ * only see zeros (or padding) and are equal to the bias. */
+static int64_t THNN_(SpatialConvolutionMM_occupiedRows)(
+          THTensor *input,
+          int kH,
+          int dH,
+          int padH,
+          int64_t nInputPlane,
+          int64_t inputWidth,
+          int64_t inputHeight,
+          int64_t outputHeight,
+          int64_t *rows)
+{
+  scalar_t *input_data = input->data<scalar_t>();
+  // nnzRows[iy] is the number of non-zero input rows before row iy
+  std::vector<int64_t> nnzRows(inputHeight + 1, 0);
+  int64_t iy, y, nip, ix;
+
+  for (iy = 0; iy < inputHeight; iy++) {
+    bool nz = false;
+    for (nip = 0; nip < nInputPlane && !nz; nip++) {
+      scalar_t *row = input_data + (nip*inputHeight + iy)*inputWidth;
+      for (ix = 0; ix < inputWidth; ix++) {
+        if (row[ix] != 0) {
+          nz = true;
+          break;
+        }
+      }
+    }
+    nnzRows[iy + 1] = nnzRows[iy] + nz;
+  }
+
+  int64_t nRows = 0;
+  for (y = 0; y < outputHeight; y++) {
+    int64_t iyStart = THMax(0, y*dH - padH);
+    int64_t iyEnd = THMin(inputHeight, y*dH - padH + kH);
+    if (iyEnd > iyStart && nnzRows[iyEnd] > nnzRows[iyStart]) {
+      rows[nRows++] = y;
+    }
+  }
+  return nRows;
+}
+
+/* Moves the compacted columns written by unfolded_copy_rows to their place
+ * in the full (nInputPlane*kH*kW) x (outputHeight*outputWidth) layout and
+ * zeroes the columns of the skipped rows, so that finput stays valid for
+ * accGradParameters. Works in place from the back, where every column block
+ * moves to a position at or after its source. */
+static void THNN_(SpatialConvolutionMM_expandRows)(
+          THTensor *finput,
+          int64_t nUnfolded,
+          int64_t outputWidth,
+          int64_t outputHeight,
+          const int64_t *rows,
+          int64_t nRows)
+{
+  scalar_t *finput_data = finput->data<scalar_t>();
+  int64_t r, j, y;
+
+  for (r = nUnfolded - 1; r >= 0; r--) {
+    scalar_t *src = finput_data + r*nRows*outputWidth;
+    scalar_t *dst = finput_data + r*outputHeight*outputWidth;
+    for (j = nRows - 1; j >= 0; j--) {
+      memmove(dst + rows[j]*outputWidth, src + j*outputWidth,
+              sizeof(scalar_t)*outputWidth);
+    }
+    for (j = 0, y = 0; y < outputHeight; y++) {
+      if (j < nRows && rows[j] == y) {
+        j++;
+      } else {
+        memset(dst + y*outputWidth, 0, sizeof(scalar_t)*outputWidth);
+      }
+    }
+  }
+}
+
 static void THNN_(SpatialConvolutionMM_updateOutput_frame)(
           THTensor *input,
           THTensor *output,
@@ -111,11 +189,61 @@ static void THNN_(SpatialConvolutionMM_updateOutput_frame)(
           int64_t inputHeight,
           int64_t nOutputPlane,
           int64_t outputWidth,
-          int64_t outputHeight)
+          int64_t outputHeight,
+          bool expandFinput)
 {
-  int64_t i;
+  int64_t i, j;
   THTensor *output2d;
 
+  // Row-sparse inputs, e.g. masked video frames: only unfold and multiply
+  // the output rows that can differ from the bias.
+  std::vector<int64_t> rows(outputHeight);
+  int64_t nRows = THNN_(SpatialConvolutionMM_occupiedRows)
+    (input, kH, dH, padH, nInputPlane, inputWidth, inputHeight,
+     outputHeight, rows.data());
+  if (nRows < outputHeight) {
+    int64_t nUnfolded = (int64_t)kW*kH*nInputPlane;
+    scalar_t *output_data = output->data<scalar_t>();
+
+    if (bias) {
+      for(i = 0; i < nOutputPlane; i++)
+        THVector_(fill)(output_data + output->stride(0) * i,
+                        THTensor_(get1d)(bias, i), outputHeight*outputWidth);
+    } else {
+      THTensor_(zero)(output);
+    }
+
+    if (nRows > 0) {
+      THNN_(unfolded_copy_rows)(finput, input, kW, kH, dW, dH, padW, padH,
+                                nInputPlane, inputWidth, inputHeight,
+                                outputWidth, outputHeight, rows.data(), nRows);
+
+      THTensor *finput2d = THTensor_(newWithStorage2d)
+        (THTensor_getStoragePtr(finput), finput->storage_offset(),
+         nUnfolded, -1, nRows*outputWidth, -1);
+      THTensor *compact2d = THTensor_(newWithSize2d)(nOutputPlane, nRows*outputWidth);
+      THTensor_(addmm)(compact2d, 0, compact2d, 1, weight, finput2d);
+
+      scalar_t *compact_data = compact2d->data<scalar_t>();
+      for(i = 0; i < nOutputPlane; i++) {
+        for(j = 0; j < nRows; j++) {
+          scalar_t *dst = output_data + output->stride(0) * i + rows[j]*outputWidth;
+          THVector_(cadd)(dst, dst, compact_data + (i*nRows + j)*outputWidth, 1, outputWidth);
+        }
+      }
+
+      c10::raw::intrusive_ptr::decref(compact2d);
+      c10::raw::intrusive_ptr::decref(finput2d);
+    }
+
+    // finput is left compacted when no backward pass will read it
+    if (expandFinput) {
+      THNN_(SpatialConvolutionMM_expandRows)
+        (finput, nUnfolded, outputWidth, outputHeight, rows.data(), nRows);
+    }
+    return;
+  }
+
   THNN_(unfolded_copy)(finput, input, kW, kH, dW, dH, padW, padH,
                        nInputPlane, inputWidth, inputHeight,
                        outputWidth, outputHeight);
@@ -176,6 +304,11 @@ void THNN_(SpatialConvolutionMM_updateOutput)(
   int64_t outputHeight = (inputHeight + 2*padH - kH) / dH + 1;
   int64_t outputWidth  = (inputWidth + 2*padW - kW) / dW + 1;
 
+  // accGradParameters reads finput in the full im2col layout, which the
+  // sparse path only restores when the forward is recorded for autograd.
+  // GradMode is thread local, so it is read here and not in the frames.
+  bool expandFinput = at::GradMode::is_enabled();
+
   if(input->dim() == 3)
   {
     THTensor_(resize2d)(finput, kW*kH*nInputPlane, outputHeight*outputWidth);
@@ -185,7 +318,7 @@ void THNN_(SpatialConvolutionMM_updateOutput)(
       (input, output, weight, bias, finput,
        kW, kH, dW, dH, padW, padH,
        nInputPlane, inputWidth, inputHeight,
-       nOutputPlane, outputWidth, outputHeight);
+       nOutputPlane, outputWidth, outputHeight, expandFinput);
   }
   else
   {
@@ -205,7 +338,7 @@ void THNN_(SpatialConvolutionMM_updateOutput)(
           (input_t, output_t, weight, bias, finput_t,
            kW, kH, dW, dH, padW, padH,
            nInputPlane, inputWidth, inputHeight,
-           nOutputPlane, outputWidth, outputHeight);
+           nOutputPlane, outputWidth, outputHeight, expandFinput);
 
         c10::raw::intrusive_ptr::decref(input_t);
         c10::raw::intrusive_ptr::decref(output_t);
@@ -422,6 +422,16 @@ TH_API void THNN_(unfolded_copy)(
           int nInputPlane,
           int inputWidth, int inputHeight,
           int outputWidth, int outputHeight);
+TH_API void THNN_(unfolded_copy_rows)(
+          THTensor *finput,
+          THTensor *input,
+          int kW, int kH,
+          int dW, int dH,
+          int padW, int padH,
+          int nInputPlane,
+          int inputWidth, int inputHeight,
+          int outputWidth, int outputHeight,
+          const int64_t *rows, int64_t nRows);
 
 TH_API void THNN_(FeatureLPPooling_updateOutput)(
           THNNState *state,
@@ -98,6 +98,33 @@ void THNN_(unfolded_copy)(
           int inputHeight,
           int outputWidth,
           int outputHeight)
+{
+  THNN_(unfolded_copy_rows)(finput, input, kW, kH, dW, dH, padW, padH,
+                            nInputPlane, inputWidth, inputHeight,
+                            outputWidth, outputHeight, NULL, outputHeight);
+}
+
+/* Same as unfolded_copy, but only for the nRows output rows listed in rows
+ * (in increasing order, all of them if rows is NULL). Column block j of
+ * finput, i.e. columns [j*outputWidth, (j+1)*outputWidth), holds output row
+ * rows[j], so that finput is a compacted (nInputPlane*kH*kW) x
+ * (nRows*outputWidth) matrix. */
+void THNN_(unfolded_copy_rows)(
+          THTensor *finput,
+          THTensor *input,
+          int kW,
+          int kH,
+          int dW,
+          int dH,
+          int padW,
+          int padH,
+          int nInputPlane,
+          int inputWidth,
+          int inputHeight,
+          int outputWidth,
+          int outputHeight,
+          const int64_t *rows,
+          int64_t nRows)
 {
   // This function assumes that
   // kH*kW does not overflow an int
@@ -114,49 +141,51 @@ void THNN_(unfolded_copy)(
       int64_t rest = k % (kH*kW);
       int64_t kh = rest / kW;
       int64_t kw = rest % kW;
-      int x, y;
-      int64_t ix, iy;
-      scalar_t *dst = finput_data + nip*((size_t)kH*kW*outputHeight*outputWidth) + kh*((size_t)kW*outputHeight*outputWidth) + kw*((size_t)outputHeight*outputWidth);
+      int x;
+      int64_t j, y, ix, iy;
+      scalar_t *dst = finput_data + nip*((size_t)kH*kW*nRows*outputWidth) + kh*((size_t)kW*nRows*outputWidth) + kw*((size_t)nRows*outputWidth);
       scalar_t *src = input_data + nip*((size_t)inputHeight*inputWidth);
       if (padW > 0 || padH > 0) {
         int64_t lpad,rpad;
-        for(y = 0; y < outputHeight; y++) {
+        for(j = 0; j < nRows; j++) {
+          y = rows ? rows[j] : j;
           iy = (int64_t)y*dH - padH + kh;
           if (iy < 0 || iy >= inputHeight) {
-            memset(dst+(size_t)y*outputWidth, 0, sizeof(scalar_t)*outputWidth);
+            memset(dst+(size_t)j*outputWidth, 0, sizeof(scalar_t)*outputWidth);
           } else {
             if (dW==1){
                ix = 0 - padW + kw;
                lpad = fmaxf(0,padW-kw);
                rpad = fmaxf(0,padW-(kW-kw-1));
                if (outputWidth-rpad-lpad <= 0) {
-                  memset(dst+(size_t)y*outputWidth, 0, sizeof(scalar_t)*outputWidth);
+                  memset(dst+(size_t)j*outputWidth, 0, sizeof(scalar_t)*outputWidth);
                } else {
-                  if (lpad > 0) memset(dst+(size_t)y*outputWidth, 0, sizeof(scalar_t)*lpad);
-                  memcpy(dst+(size_t)y*outputWidth+lpad, src+(size_t)iy*inputWidth+ix+lpad, sizeof(scalar_t)*(outputWidth-rpad-lpad));
-                  if (rpad > 0) memset(dst+(size_t)y*outputWidth + outputWidth - rpad, 0, sizeof(scalar_t)*rpad);
+                  if (lpad > 0) memset(dst+(size_t)j*outputWidth, 0, sizeof(scalar_t)*lpad);
+                  memcpy(dst+(size_t)j*outputWidth+lpad, src+(size_t)iy*inputWidth+ix+lpad, sizeof(scalar_t)*(outputWidth-rpad-lpad));
+                  if (rpad > 0) memset(dst+(size_t)j*outputWidth + outputWidth - rpad, 0, sizeof(scalar_t)*rpad);
                }
             }
             else{
               for (x=0; x<outputWidth; x++){
                  ix = (int64_t)x*dW - padW + kw;
                  if (ix < 0 || ix >= inputWidth)
-                   memset(dst+(size_t)y*outputWidth+x, 0, sizeof(scalar_t)*1);
+                   memset(dst+(size_t)j*outputWidth+x, 0, sizeof(scalar_t)*1);
                  else
-                   memcpy(dst+(size_t)y*outputWidth+x, src+(size_t)iy*inputWidth+ix, sizeof(scalar_t)*(1));
+                   memcpy(dst+(size_t)j*outputWidth+x, src+(size_t)iy*inputWidth+ix, sizeof(scalar_t)*(1));
               }
             }
           }
         }
       } else {
-        for(y = 0; y < outputHeight; y++) {
+        for(j = 0; j < nRows; j++) {
+          y = rows ? rows[j] : j;
           iy = (int64_t)y*dH + kh;
           ix = 0 + kw;
           if (dW == 1)
-             memcpy(dst+(size_t)y*outputWidth, src+(size_t)iy*inputWidth+ix, sizeof(scalar_t)*outputWidth);
+             memcpy(dst+(size_t)j*outputWidth, src+(size_t)iy*inputWidth+ix, sizeof(scalar_t)*outputWidth);
           else{
             for (x=0; x<outputWidth; x++)
-               memcpy(dst+(size_t)y*outputWidth+x, src+(size_t)iy*inputWidth+ix+(int64_t)x*dW, sizeof(scalar_t)*(1));
+               memcpy(dst+(size_t)j*outputWidth+x, src+(size_t)iy*inputWidth+ix+(int64_t)x*dW, sizeof(scalar_t)*(1));
            }
         }
       }
@@ -0,0 +1,182 @@
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+from __future__ import unicode_literals
+
+import os
+
+import operator_benchmark as op_bench
+import torch
+import torch.nn as nn
+import torch.nn.functional as F
+
+
+"""
+Microbenchmarks for the sparse MKL-DNN Conv2d on row-sparse inputs.
+
+Every config runs the same convolution on the same masked input with three
+backends: "sparse" (torch.mkldnn_convolution_sparse, which skips all-zero
+rows), "mkldnn" (dense torch.mkldnn_convolution) and "thnn" (the native
+im2col convolution), so the first should be compared against the other two.
+The reported time is per batch; divide by N for the time per frame.
+
+The inputs are zero outside a mask that covers about `density` of the
+frame, shaped as
+    rows:  random rows
+    band:  one contiguous band of rows per frame
+    blobs: a few rectangles per frame
+    clip:  masks replayed from a recorded clip, a uint8 [T, H, W] tensor
+           saved with torch.save to the file named by the
+           SPARSE_CONV_MASK_CLIP environment variable (skipped if unset)
+
+Example:
+    $ python -m pt.sparse_conv_test --tag_filter short
+"""
+
+
+# Configs for sparse Conv2d
+sparse_conv_short_configs = op_bench.cross_product_configs(
+    in_c=[16],
+    out_c=[32],
+    kernel=[3],
+    stride=[1],
+    N=[1, 8],
+    H=[112],
+    W=[112],
+    mask=["rows", "band", "blobs"],
+    density=[0.1, 0.5],
+    threads=[1, 4],
+    backend=["sparse", "mkldnn", "thnn"],
+    tags=["short"]
+)
+
+sparse_conv_long_configs = op_bench.cross_product_configs(
+    in_c=[16, 64],
+    out_c=[64],
+    kernel=[1, 3, 7],
+    stride=[1, 2],
+    N=[1, 8],
+    H=[224],
+    W=[224],
+    mask=["rows", "band", "blobs"],
+    density=[0.05, 0.25, 1.0],
+    threads=[1, 4, 16],
+    backend=["sparse", "mkldnn", "thnn"],
+    tags=["long"]
+)
+
+clip_path = os.environ.get("SPARSE_CONV_MASK_CLIP")
+
+# the density is the clip's own
+sparse_conv_clip_configs = op_bench.cross_product_configs(
+    in_c=[3, 16],
+    out_c=[64],
+    kernel=[3, 7],
+    stride=[2],
+    N=[1, 16],
+    H=[224],
+    W=[224],
+    mask=["clip"],
+    density=[0.],
+    threads=[1, 4],
+    backend=["sparse", "mkldnn", "thnn"],
+    tags=["clip"]
+) if clip_path else []
+
+
+def make_mask(kind, N, H, W, density):
+    """A [N, H, W] uint8 mask with about `density` of it set"""
+    mask = torch.zeros(N, H, W, dtype=torch.uint8)
+    if kind == "rows":
+        mask[torch.rand(N, H) < density] = 1
+    elif kind == "band":
+        rows = max(1, int(round(density * H)))
+        for n in range(N):
+            top = torch.randint(0, H - rows + 1, (1,)).item()
+            mask[n, top:top + rows] = 1
+    elif kind == "blobs":
+        blobs = 4
+        # blobs of side sqrt(density / blobs) of the frame, overlaps aside
+        side = (density / blobs) ** 0.5
+        h, w = max(1, int(side * H)), max(1, int(side * W))
+        for n in range(N):
+            for _ in range(blobs):
+                top = torch.randint(0, H - h + 1, (1,)).item()
+                left = torch.randint(0, W - w + 1, (1,)).item()
+                mask[n, top:top + h, left:left + w] = 1
+    else:
+        raise ValueError("unknown mask kind: {}".format(kind))
+    return mask
+
+
+def clip_masks(N, H, W):
+    """The recorded clip resized to H x W, as consecutive batches of N frames"""
+    clip = torch.load(clip_path).ne(0).float().unsqueeze(1)
+    clip = F.interpolate(clip, size=(H, W), mode="nearest").squeeze(1)
+    clip = clip.to(torch.uint8)
+    return [clip[t:t + N] for t in range(0, clip.size(0) - N + 1, N)]
+
+
+# The configs that only differ in the convolution or the backend share their
+# inputs, which are only made for the configs that run
+masked_inputs = {}
+
+
+def get_masked_inputs(in_c, N, H, W, mask, density):
+    key = (in_c, N, H, W, mask, density)
+    if key not in masked_inputs:
+        if mask == "clip":
+            masks = clip_masks(N, H, W)
+        else:
+            masks = [make_mask(mask, N, H, W, density)]
+        masked_inputs[key] = [
+            torch.rand(N, in_c, H, W) * m.unsqueeze(1).float() for m in masks]
+    return masked_inputs[key]
+
+
+class SparseConv2dBenchmark(op_bench.TorchBenchmarkBase):
+    def init(self, in_c, out_c, kernel, stride, N, H, W, mask, density, threads, backend):
+        self.input_config = (in_c, N, H, W, mask, density)
+        self.inputs = None
+        self.frame = 0
+        self.threads = threads
+        self.conv2d = nn.Conv2d(in_c, out_c, kernel, stride=stride, padding=kernel // 2)
+        self.args = (self.conv2d.weight, self.conv2d.bias,
+                     [kernel // 2] * 2, [stride] * 2, [1, 1], 1)
+        self.kernel_size = [kernel] * 2
+        self.backend = backend
+        self.set_module_name("SparseConv2d")
+
+    def forward(self):
+        # set per call, since all the configs of a run share the process, and
+        # restored afterwards for the benchmarks that run after this one
+        num_threads = torch.get_num_threads()
+        torch.set_num_threads(self.threads)
+        try:
+            return self._conv()
+        finally:
+            torch.set_num_threads(num_threads)
+
+    def _conv(self):
+        # made by the warmup iterations
+        if self.inputs is None:
+            self.inputs = get_masked_inputs(*self.input_config)
+        input = self.inputs[self.frame]
+        self.frame = (self.frame + 1) % len(self.inputs)
+        with torch.no_grad():
+            if self.backend == "sparse":
+                return torch.mkldnn_convolution_sparse(input, *self.args)
+            if self.backend == "mkldnn":
+                return torch.mkldnn_convolution(input, *self.args)
+            weight, bias, padding, stride, _, _ = self.args
+            return torch._C._nn.thnn_conv2d(
+                input, weight, self.kernel_size, bias, stride, padding)
+
+
+op_bench.generate_pt_test(
+    sparse_conv_short_configs + sparse_conv_long_configs + sparse_conv_clip_configs,
+    SparseConv2dBenchmark)
+
+
+if __name__ == "__main__":
+    op_bench.benchmark_runner.main()
@@ -14,12 +14,20 @@
 * limitations under the License.
 *******************************************************************************/
 
+#include <atomic>
+#include <chrono>
+#include <string.h>
+
+#include "mkldnn.h"
+
 #include "c_types_map.hpp"
 #include "mkldnn_thread.hpp"
 #include "type_helpers.hpp"
 #include "utils.hpp"
 
 #include "jit_avx512_common_convolution.hpp"
+#include "jit_generator.hpp"
+#include "ref_eltwise.hpp"
 
 namespace mkldnn {
 namespace impl {
@@ -123,6 +131,446 @@ void jit_conv_3d_ker_bwd_w_pipeline(jit_conv_ker_t ker, jit_conv_call_s &p,
     if (p.src)
         ker(&p);
 }
+
+namespace {
+
+/* Sparse row skipping
+ *
+ * On row-sparse inputs (e.g. motion-masked video frames) most output rows see
+ * only zero input rows in their receptive field, so the kernel call for them
+ * can be skipped. Instead of scanning the receptive field for every oc chunk,
+ * icb and thread, the occupancy of the input is computed once per execute()
+ * into a bitmap with one bit per (mb, ngroups * nb_ic, id * ih) input row,
+ * optionally split into segments along iw. The backward passes use the same
+ * bitmap on diff_dst (BWD_D) or on both src and diff_dst (BWD_W).
+ *
+ * How the bitmap is obtained is controlled per calling thread through
+ * mkldnn_sparse_conv_set_hint() (see the end of this file). */
+
+enum sparse_conv_mode_t {
+    sparse_conv_dense = 0,
+    sparse_conv_scan = 1,
+    sparse_conv_row_mask = 2,
+};
+
+struct sparse_conv_hint_t {
+    int mode;
+    const uint8_t *row_mask;
+    int mb, nrows;
+};
+
+/* Read by execute() on the thread that runs the primitive, before any
+ * parallel region is entered */
+thread_local sparse_conv_hint_t sparse_conv_hint
+    = { sparse_conv_scan, nullptr, 0, 0 };
+
+/* Counters of the 2D forward executions on the calling thread since the last
+ * mkldnn_sparse_conv_get_stats(). Output rows are counted per (mb, group,
+ * oh, ow block) tile, times in nanoseconds. */
+struct sparse_conv_stats_t {
+    int64_t calls;
+    int64_t rows;
+    int64_t rows_skipped;
+    int64_t scan_ns;
+    int64_t kernel_ns;
+    int64_t thr_max_ns;
+    int64_t thr_avg_ns;
+};
+
+thread_local sparse_conv_stats_t sparse_conv_stats = {};
+
+inline int64_t stats_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/* Returns non-zero iff any of the first `len` dwords at `src` is non-zero.
+ * With `ignore_sign` the sign bit of every dword is masked off, so that -0.f
+ * is treated as zero for f32 data. */
+struct jit_avx512_common_nz_scan_t: public jit_generator {
+    DECLARE_CPU_JIT_AUX_FUNCTIONS(jit_avx512_common_nz_scan_t)
+
+    jit_avx512_common_nz_scan_t(bool ignore_sign)
+        : ignore_sign_(ignore_sign) {
+        generate();
+        ker_ = (decltype(ker_))this->getCode();
+    }
+
+    bool operator()(const void *src, size_t len) const
+    { return ker_(src, len) != 0; }
+
+private:
+    enum { simd_w = 16, unroll = 4, vlen = 64 };
+
+    const bool ignore_sign_;
+    int (*ker_)(const void *, size_t);
+
+    Xbyak::Reg64 reg_src = r8;
+    Xbyak::Reg64 reg_len = r9;
+    Xbyak::Reg64 reg_tmp = r10;
+
+    Xbyak::Opmask k_nz = k1;
+    Xbyak::Opmask k_tail = k2;
+
+    Xbyak::Zmm zmm_acc = zmm0;
+    Xbyak::Zmm zmm_mask = zmm1;
+    Xbyak::Zmm zmm_tail = zmm2;
+
+    /* ZF is cleared iff the accumulator holds a non-zero (masked) dword */
+    void test_acc() {
+        vptestmd(k_nz, zmm_acc, ignore_sign_ ? zmm_mask : zmm_acc);
+        kortestw(k_nz, k_nz);
+    }
+
+    void generate() {
+        Xbyak::Label l_unroll, l_single, l_tail, l_done, l_nz;
+
+        preamble();
+
+        mov(reg_src, abi_param1);
+        mov(reg_len, abi_param2);
+
+        vpxord(zmm_acc, zmm_acc, zmm_acc);
+        if (ignore_sign_) {
+            mov(reg_tmp.cvt32(), 0x7fffffff);
+            vpbroadcastd(zmm_mask, reg_tmp.cvt32());
+        }
+
+        L(l_unroll); {
+            cmp(reg_len, unroll * simd_w);
+            jl(l_single, T_NEAR);
+            for (int u = 0; u < unroll; ++u)
+                vpord(zmm_acc, zmm_acc, ptr[reg_src + u * vlen]);
+            /* leave as soon as a non-zero is found: occupied rows are
+             * usually recognized within the first few vectors */
+            test_acc();
+            jnz(l_nz, T_NEAR);
+            add(reg_src, unroll * vlen);
+            sub(reg_len, unroll * simd_w);
+            jmp(l_unroll, T_NEAR);
+        }
+
+        L(l_single); {
+            cmp(reg_len, simd_w);
+            jl(l_tail, T_NEAR);
+            vpord(zmm_acc, zmm_acc, ptr[reg_src]);
+            add(reg_src, vlen);
+            sub(reg_len, simd_w);
+            jmp(l_single, T_NEAR);
+        }
+
+        L(l_tail); {
+            test(reg_len, reg_len);
+            jz(l_done, T_NEAR);
+            /* params are already moved out, so rcx is free on both ABIs */
+            mov(rcx, reg_len);
+            mov(reg_tmp.cvt32(), 1);
+            shl(reg_tmp.cvt32(), cl);
+            sub(reg_tmp.cvt32(), 1);
+            kmovw(k_tail, reg_tmp.cvt32());
+            vmovdqu32(zmm_tail | k_tail | T_z, ptr[reg_src]);
+            vpord(zmm_acc, zmm_acc, zmm_tail);
+        }
+
+        L(l_done);
+        test_acc();
+        L(l_nz);
+        setnz(al);
+        movzx(eax, al);
+
+        postamble();
+    }
+};
+
+const jit_avx512_common_nz_scan_t &nz_scan_kernel(bool ignore_sign) {
+    static const jit_avx512_common_nz_scan_t ker_f32(true), ker_int(false);
+    return ignore_sign ? ker_f32 : ker_int;
+}
+
+template <typename data_t>
+bool nz_scan(const data_t *src, size_t nelems) {
+    const auto &ker = nz_scan_kernel(
+            nstl::is_same<data_t, float>::value);
+    const size_t nbytes = nelems * sizeof(data_t);
+    if (ker(src, nbytes / sizeof(int32_t)))
+        return true;
+    /* s16 rows of odd width end with a half dword */
+    auto tail = reinterpret_cast<const char *>(src)
+        + nbytes / sizeof(int32_t) * sizeof(int32_t);
+    for (size_t i = 0; i < nbytes % sizeof(int32_t); ++i)
+        if (tail[i] != 0) return true;
+    return false;
+}
+
+struct row_occupancy_t {
+    row_occupancy_t(int mb, int ngroups, int nb_c, int nrows, int iw,
+            int col_w = 0)
+        : mb_(mb), ngroups_(ngroups), nb_c_(nb_c), nrows_(nrows), iw_(iw)
+        , col_w_(col_w > 0 ? col_w : iw)
+        , ncols_(utils::div_up(iw, col_w_))
+        , words_(utils::div_up(nrows, word_bits))
+        , bits_(nullptr), grp_bits_(nullptr) {
+        bits_ = (uint64_t *)impl::malloc(sizeof(uint64_t)
+                * mb_ * ngroups_ * nb_c_ * ncols_ * words_, 64);
+        grp_bits_ = (uint64_t *)impl::malloc(sizeof(uint64_t)
+                * mb_ * ngroups_ * ncols_ * words_, 64);
+    }
+    ~row_occupancy_t() { impl::free(bits_); impl::free(grp_bits_); }
+
+    /* Fills the bitmap from `src`; `row_off(n, ch, r)` is the offset of
+     * the first pixel of row r. Segments of blocked formats are contiguous
+     * (col_w * c_block elements), in the `plain` format used by the first
+     * convolution every channel of the block is scanned separately.
+     * In dense mode nothing is scanned and every row is occupied; a row
+     * mask of matching shape replaces the scan when `maskable` (i.e. `src`
+     * is the tensor the caller computed the mask for). */
+    template <typename data_t, typename row_off_t>
+    void init(const data_t *src, row_off_t row_off, size_t w_stride,
+            int c_block, bool plain, bool maskable = false) {
+        const sparse_conv_hint_t &hint = sparse_conv_hint;
+        if (hint.mode == sparse_conv_dense) {
+            set_all();
+            return;
+        }
+        if (maskable && hint.mode == sparse_conv_row_mask
+                && hint.row_mask != nullptr && hint.mb == mb_
+                && hint.nrows == nrows_) {
+            init(hint.row_mask);
+            return;
+        }
+
+        const int elems_per_pix = plain ? 1 : c_block;
+        const int nch = plain ? c_block : 1;
+
+        parallel_nd(mb_, ngroups_ * nb_c_, ncols_ * words_,
+                [&](int n, int c, int cw) {
+            const int col = cw / words_, w = cw % words_;
+            const int iw_s = col * col_w_;
+            const size_t len = (size_t)elems_per_pix
+                * (nstl::min(iw_, iw_s + col_w_) - iw_s);
+
+            uint64_t word = 0;
+            const int r_end = nstl::min(nrows_, (w + 1) * word_bits);
+            for (int r = w * word_bits; r < r_end; ++r) {
+                bool nz = false;
+                for (int ch = 0; ch < nch && !nz; ++ch) {
+                    const size_t off = plain
+                        ? row_off(n, c * c_block + ch, r)
+                        : row_off(n, c, r);
+                    nz = nz_scan(src + off + iw_s * w_stride, len);
+                }
+                if (nz) word |= (uint64_t)1 << (r % word_bits);
+            }
+            plane(n, c, col)[w] = word;
+        });
+
+        parallel_nd(mb_, ngroups_, ncols_ * words_,
+                [&](int n, int g, int cw) {
+            const int col = cw / words_, w = cw % words_;
+            uint64_t word = 0;
+            for (int c = g * nb_c_; c < (g + 1) * nb_c_; ++c)
+                word |= plane(n, c, col)[w];
+            grp_plane(n, g, col)[w] = word;
+        });
+    }
+
+    /* Fills the bitmap from an mb x nrows byte mask, non-zero for occupied
+     * rows, which applies to all channel blocks and segments */
+    void init(const uint8_t *row_mask) {
+        parallel_nd(mb_, words_, [&](int n, int w) {
+            uint64_t word = 0;
+            const int r_end = nstl::min(nrows_, (w + 1) * word_bits);
+            for (int r = w * word_bits; r < r_end; ++r)
+                if (row_mask[(size_t)n * nrows_ + r] != 0)
+                    word |= (uint64_t)1 << (r % word_bits);
+            for (int col = 0; col < ncols_; ++col) {
+                for (int c = 0; c < ngroups_ * nb_c_; ++c)
+                    plane(n, c, col)[w] = word;
+                for (int g = 0; g < ngroups_; ++g)
+                    grp_plane(n, g, col)[w] = word;
+            }
+        });
+    }
+
+    /* Marks every row as occupied, which turns all skipping off */
+    void set_all() {
+        const size_t nplanes = (size_t)mb_ * ngroups_ * ncols_;
+        utils::array_set(bits_, ~(uint64_t)0, nplanes * nb_c_ * words_);
+        utils::array_set(grp_bits_, ~(uint64_t)0, nplanes * words_);
+    }
+
+    /* Segments [col_s, col_e) covering input columns [iw_lo, iw_hi] */
+    void cols(int iw_lo, int iw_hi, int &col_s, int &col_e) const {
+        iw_lo = nstl::max(0, iw_lo);
+        iw_hi = nstl::min(iw_ - 1, iw_hi);
+        col_s = iw_lo / col_w_;
+        col_e = iw_lo > iw_hi ? col_s : iw_hi / col_w_ + 1;
+    }
+
+    /* Checks rows r_s, r_s + step, ..., r_s + (len - 1) * step of channel
+     * block `c` (counted across groups) in segments [col_s, col_e) */
+    bool any(int n, int c, int r_s, int len, int step,
+            int col_s = 0, int col_e = -1) const {
+        if (col_e < 0) col_e = ncols_;
+        for (int col = col_s; col < col_e; ++col)
+            if (test(plane(n, c, col), r_s, len, step)) return true;
+        return false;
+    }
+
+    /* Checks the whole plane of channel block `c` */
+    bool any(int n, int c) const { return any(n, c, 0, nrows_, 1); }
+
+    /* Same as any(), but for all channel blocks of group `g` at once */
+    bool any_in_group(int n, int g, int r_s, int len, int step,
+            int col_s = 0, int col_e = -1) const {
+        if (col_e < 0) col_e = ncols_;
+        for (int col = col_s; col < col_e; ++col)
+            if (test(grp_plane(n, g, col), r_s, len, step)) return true;
+        return false;
+    }
+
+private:
+    enum { word_bits = 64 };
+
+    uint64_t *plane(int n, int c, int col) const {
+        return bits_
+            + (((size_t)n * ngroups_ * nb_c_ + c) * ncols_ + col) * words_;
+    }
+    uint64_t *grp_plane(int n, int g, int col) const {
+        return grp_bits_
+            + (((size_t)n * ngroups_ + g) * ncols_ + col) * words_;
+    }
+
+    static bool test(const uint64_t *p, int r_s, int len, int step) {
+        if (len <= 0) return false;
+        if (step != 1) {
+            for (int i = 0, r = r_s; i < len; ++i, r += step)
+                if (p[r / word_bits] & ((uint64_t)1 << (r % word_bits)))
+                    return true;
+            return false;
+        }
+        const int r_l = r_s + len - 1;
+        const int w_s = r_s / word_bits, w_l = r_l / word_bits;
+        for (int w = w_s; w <= w_l; ++w) {
+            uint64_t m = ~(uint64_t)0;
+            if (w == w_s) m &= ~(uint64_t)0 << (r_s % word_bits);
+            if (w == w_l)
+                m &= ~(uint64_t)0 >> (word_bits - 1 - r_l % word_bits);
+            if (p[w] & m) return true;
+        }
+        return false;
+    }
+
+    const int mb_, ngroups_, nb_c_, nrows_, iw_, col_w_, ncols_, words_;
+    uint64_t *bits_, *grp_bits_;
+};
+
+/* Writes a row of output blocks that the driver skips on the first icb pass:
+ * bias (or zero), plus the previous dst value for the sum post-op. The row
+ * is `finalize`d when it is skipped for every icb, i.e. no kernel call will
+ * follow to apply the eltwise post-op. This keeps dst well-defined without
+ * requiring the caller to zero it. */
+template <typename dst_data_t>
+void fill_skipped_row(dst_data_t *dst, size_t dst_c_stride,
+        const dst_data_t *bias, int ow_len, bool finalize,
+        const jit_conv_conf_t &jcp) {
+    const int oc_block = jcp.oc_block;
+    assert(oc_block <= 16);
+    const bool with_eltwise = finalize && jcp.with_eltwise;
+
+    for (int ocb = 0; ocb < jcp.nb_oc_blocking; ++ocb) {
+        dst_data_t *d = dst + ocb * dst_c_stride;
+        const dst_data_t *b = bias ? bias + ocb * oc_block : nullptr;
+
+        if (!jcp.with_sum) {
+            /* the value only depends on oc: compute it once and broadcast */
+            dst_data_t v[16];
+            for (int o = 0; o < oc_block; ++o)
+                v[o] = b ? b[o] : (dst_data_t)0;
+            if (with_eltwise) {
+                ref_eltwise_scalar_fwd_t eltwise(jcp.eltwise.alg,
+                        jcp.eltwise.alpha, jcp.eltwise.beta);
+                for (int o = 0; o < oc_block; ++o)
+                    v[o] = (dst_data_t)eltwise.compute_scalar((float)v[o]);
+            }
+            for (int ow = 0; ow < ow_len; ++ow) {
+                PRAGMA_OMP_SIMD()
+                for (int o = 0; o < oc_block; ++o)
+                    d[ow * oc_block + o] = v[o];
+            }
+            continue;
+        }
+
+        if (b) {
+            for (int ow = 0; ow < ow_len; ++ow) {
+                PRAGMA_OMP_SIMD()
+                for (int o = 0; o < oc_block; ++o)
+                    d[ow * oc_block + o] += b[o];
+            }
+        }
+        if (with_eltwise) {
+            ref_eltwise_scalar_fwd_t eltwise(jcp.eltwise.alg,
+                    jcp.eltwise.alpha, jcp.eltwise.beta);
+            for (int i = 0; i < ow_len * oc_block; ++i)
+                d[i] = (dst_data_t)eltwise.compute_scalar((float)d[i]);
+        }
+    }
+}
+
+/* An occupied output row of the 2D forward driver */
+struct conv_row_t {
+    int n, oj;
+};
+
+/* A run [r_s, r_e) of the compacted occupied output rows of one (group,
+ * oc chunk, ow block), gathered over the whole minibatch */
+struct conv_work_item_t {
+    int g, occ, owb;
+    size_t r_s, r_e;
+};
+
+/* Distributes weighted work items over threads. Every thread starts with a
+ * contiguous range of items of roughly equal total weight (`wcum` holds the
+ * prefix sums of the weights, nitems + 1 entries), and once its own range
+ * runs dry it steals the remaining items of other threads. Ranges of
+ * threads that were not spawned at all are picked up the same way. */
+struct work_queue_t {
+    work_queue_t(const size_t *wcum, int nitems, int nthr)
+        : nthr_(nthr), cursors_(new cursor_t[nthr]) {
+        int lo = 0;
+        for (int ithr = 0; ithr < nthr_; ++ithr) {
+            const size_t w_end = wcum[nitems] * (ithr + 1) / nthr_;
+            int hi = lo;
+            while (hi < nitems && wcum[hi + 1] <= w_end) ++hi;
+            if (ithr == nthr_ - 1) hi = nitems;
+            cursors_[ithr].next = lo;
+            cursors_[ithr].end = hi;
+            lo = hi;
+        }
+    }
+    ~work_queue_t() { delete[] cursors_; }
+
+    template <typename F> void run(int ithr, F f) {
+        for (int k = 0; k < nthr_; ++k) {
+            cursor_t &c = cursors_[(ithr + k) % nthr_];
+            for (int i = c.next++; i < c.end; i = c.next++)
+                f(i);
+        }
+    }
+
+private:
+    struct cursor_t {
+        std::atomic<int> next;
+        int end;
+        char pad_[64 - sizeof(std::atomic<int>) - sizeof(int)];
+    };
+
+    const int nthr_;
+    cursor_t *cursors_;
+};
+
+}
+
 #define wht_blk_off(d, g, ...) \
         (pd()->with_groups() \
          ? (d).blk_off((g), __VA_ARGS__) \
@@ -169,6 +617,16 @@ void jit_avx512_common_convolution_fwd_t
     else
         nthr = mkldnn_get_max_threads();
 
+    /* the single row of a 1D input is split into segments of about the
+     * input window of an ow block */
+    row_occupancy_t src_occ(jcp.mb, jcp.ngroups, jcp.nb_ic, 1, jcp.iw,
+            jcp.ow_block * jcp.stride_w);
+    src_occ.init(src,
+            [&](int n, int c, int) { return src_d.blk_off(n, c); },
+            src_d.blk_off(0, 0, 1), jcp.ic_block,
+            jcp.is_1stconv, true);
+    const size_t dst_c_stride = dst_d.blk_off(0, 1);
+
     parallel(nthr, [&](const int ithr, const int nthr) {
         int start{0}, end{0}, start_copy;
         balance211(work_amount, nthr, ithr, start, end);
@@ -202,15 +660,36 @@ void jit_avx512_common_convolution_fwd_t
 
                 int ow_s =  owb * jcp.ow_block;
                 int iw_s =  ow_s * jcp.stride_w;
+                int ow_len = nstl::min(jcp.ow - ow_s, jcp.ow_block);
                 auto bias_w = bias ? bias + g_oc : nullptr;
                 auto dst_w = dst + dst_d.blk_off(n, g_ocb, ow_s);
                 auto src_w = src + src_d.blk_off(n, g_icb + icb_l2, iw_s);
                 auto wht_w = weights + wht_blk_off(weights_d, g, ocb, icb_l2);
 
+                /* skip ow blocks with all-zero input window, following the
+                 * same rules as the rows of execute_forward_2d() */
+                int col_s{0}, col_e{0};
+                src_occ.cols(iw_s - jcp.l_pad, (ow_s + ow_len - 1)
+                        * jcp.stride_w - jcp.l_pad
+                        + (jcp.kw - 1) * (jcp.dilate_w + 1), col_s, col_e);
+                bool blk_empty = !src_occ.any_in_group(n, g, 0, 1, 1,
+                        col_s, col_e);
+
                 for (int icb = icb_l2;
                      icb < min(jcp.nb_ic, icb_l2 + jcp.nb_ic_L2); ++icb) {
-                     jit_conv_ker_pipeline_ow_thr(kernel_->jit_ker, par_conv,
-                        src_w, dst_w, wht_w, bias_w, icb, 1, owb);
+                    bool skip = blk_empty || !src_occ.any(n,
+                            g * jcp.nb_ic + icb, 0, 1, 1, col_s, col_e);
+                    if (skip && !blk_empty && jcp.with_eltwise
+                            && icb == jcp.nb_ic - 1)
+                        skip = false;
+
+                    if (!skip)
+                        jit_conv_ker_pipeline_ow_thr(kernel_->jit_ker,
+                            par_conv, src_w, dst_w, wht_w, bias_w, icb, 1,
+                            owb);
+                    else if (icb == 0)
+                        fill_skipped_row(dst_w, dst_c_stride, bias_w, ow_len,
+                                blk_empty, jcp);
 
                     src_w += src_c_stride;
                     wht_w += wht_ic_stride;
@@ -244,7 +723,6 @@ void jit_avx512_common_convolution_fwd_t
     auto dst = reinterpret_cast<dst_data_t *>(this->memory());
 
     prepare_padded_bias(bias);
-    //printf("ahhhhhhhhhhhhhhhhhhhhh\n");
 
     const memory_desc_wrapper src_d(pd()->src_pd());
     const memory_desc_wrapper dst_d(pd()->dst_pd());
@@ -254,115 +732,254 @@ void jit_avx512_common_convolution_fwd_t
     assert(jcp.nb_oc % jcp.nb_oc_blocking == 0);
 
     int oc_chunks = jcp.nb_oc / jcp.nb_oc_blocking;
-    int work_amount = jcp.mb * jcp.ngroups * oc_chunks * jcp.oh * jcp.nb_ow;
 
     int nthr;
     if (jcp.aligned_threads)
         nthr = jcp.aligned_threads;
     else
         nthr = mkldnn_get_max_threads();
-    nthr = 150;//Using artificial thread number to reduce per thread workload- breaking bottleneck of maximum speed
 
-    parallel(nthr, [&](const int ithr, const int nthr) {
-        int start{0}, end{0}, start_copy;
-        balance211(work_amount, nthr, ithr, start, end);
-        start_copy = start;
-
-        auto par_conv = jit_conv_call_s();
-        size_t src_h_stride = src_d.blk_off(0, 0, 1);
-        size_t src_c_stride = src_d.blk_off(0, 1);
-        size_t dst_h_stride = dst_d.blk_off(0, 0, 1);
-        size_t wht_h_stride = wht_blk_off(weights_d, 0, 0, 0, 1);
-        size_t wht_ic_stride = wht_blk_off(weights_d, 0, 0, 1);
+    /* With ow blocking the occupancy is kept per (row, ow block input
+     * window) tile, so that the kernel is only called for the tiles whose
+     * receptive field touches a non-zero pixel. The tile width follows
+     * jcp.ow_block, the smallest unit the kernel can be called for. */
+    const int64_t t_scan = stats_now_ns();
+    row_occupancy_t src_occ(jcp.mb, jcp.ngroups, jcp.nb_ic, jcp.ih, jcp.iw,
+            jcp.nb_ow > 1 ? jcp.ow_block * jcp.stride_w : jcp.iw);
+    src_occ.init(src,
+            [&](int n, int c, int r) { return src_d.blk_off(n, c, r); },
+            src_d.blk_off(0, 0, 0, 1), jcp.ic_block,
+            jcp.is_1stconv, true);
+    const int64_t t_kernel = stats_now_ns();
+
+    const int dilate_h = jcp.dilate_h + 1;
+    auto row_rf = [&](int ij, int &i_t_overflow, int &kh_padding) {
+        i_t_overflow = div_up(max(0, -ij), dilate_h);
+        int i_b_overflow = div_up(max(0, ij - jcp.ih
+            + (jcp.kh - 1) * dilate_h + 1), dilate_h);
+        kh_padding = nstl::max(0, jcp.kh - i_t_overflow - i_b_overflow);
+    };
+    auto tile_cols = [&](int owb, int &col_s, int &col_e) {
+        int ow_s = owb * jcp.ow_block;
+        int ow_l = nstl::min(jcp.ow, ow_s + jcp.ow_block) - 1;
+        src_occ.cols(ow_s * jcp.stride_w - jcp.l_pad,
+                ow_l * jcp.stride_w - jcp.l_pad
+                + (jcp.kw - 1) * (jcp.dilate_w + 1), col_s, col_e);
+    };
+    auto tile_empty = [&](int n, int g, int oj, int owb) {
+        int ij = -jcp.t_pad + oj * jcp.stride_h;
+        int i_t_overflow, kh_padding, col_s, col_e;
+        row_rf(ij, i_t_overflow, kh_padding);
+        tile_cols(owb, col_s, col_e);
+        return !src_occ.any_in_group(n, g, ij + i_t_overflow * dilate_h,
+                kh_padding, dilate_h, col_s, col_e);
+    };
 
-        for (int icb_l2 = 0 ; icb_l2 < jcp.nb_ic; icb_l2 += jcp.nb_ic_L2) {
-            start = start_copy;
-            int n{0}, g{0}, occ{0}, oh_s{0}, owb{0};
+    /* Finalize the tiles that are empty for every icb right away and gather
+     * the occupied output rows of every (group, ow block) over the whole
+     * minibatch into one compacted list. Work items are runs of that list,
+     * cut by row count and not by image, so the threads stream through the
+     * non-empty row windows of all images as if they formed one dense
+     * image: the cost of a batch follows its total foreground area rather
+     * than mb times the frame size, and the weights of a (group, oc chunk)
+     * stay hot across images. The kernel is called per output row anyway,
+     * so the gather needs no copies, only an (n, oj) pair per row. */
+    const int items_per_thr = 4;
+    const int nb_seg = jcp.ngroups * jcp.nb_ow;
+    const size_t seg_len = (size_t)jcp.mb * jcp.oh;
+    auto seg_off = [&](int g, int owb) { return g * jcp.nb_ow + owb; };
+
+    /* the scan is split along oh too, so that batch 1 keeps all threads
+     * busy; block (n, ohb) of a segment is staged at rows n * oh + ohb *
+     * oh_blk and compacted afterwards */
+    int oh_blk = div_up(jcp.oh, nstl::max(1, nstl::min(jcp.oh,
+            div_up(items_per_thr * nthr, jcp.mb * nb_seg))));
+    const int nb_oh = div_up(jcp.oh, oh_blk);
+
+    const size_t dst_c_stride = dst_d.blk_off(0, 1);
+    auto rows = (conv_row_t *)impl::malloc(
+            sizeof(conv_row_t) * nb_seg * seg_len, 64);
+    int *occupied = (int *)impl::malloc(
+            sizeof(int) * nb_seg * jcp.mb * nb_oh, 64);
+    auto occupied_off = [&](int g, int owb, int n, int ohb) {
+        return (seg_off(g, owb) * jcp.mb + n) * nb_oh + ohb;
+    };
 
-            if (jcp.loop_order == loop_cwgn)
-                nd_iterator_init(start, occ, oc_chunks, owb, jcp.nb_ow,
-                    g, jcp.ngroups, n, jcp.mb, oh_s, jcp.oh);
-            else if (jcp.loop_order == loop_gncw)
-                nd_iterator_init(start, g, jcp.ngroups, n, jcp.mb,
-                    occ, oc_chunks, owb, jcp.nb_ow, oh_s, jcp.oh);
-            else
-                assert(!"unsupported loop order");
+    parallel_nd(jcp.ngroups, jcp.nb_ow, jcp.mb, nb_oh,
+            [&](int g, int owb, int n, int ohb) {
+        int ow_s = owb * jcp.ow_block;
+        int ow_len = nstl::min(jcp.ow - ow_s, jcp.ow_block);
+        const int oh_s = ohb * oh_blk;
+        conv_row_t *blk_rows = rows + seg_off(g, owb) * seg_len
+            + (size_t)n * jcp.oh + oh_s;
+        int cnt = 0;
+        for (int oj = oh_s; oj < nstl::min(jcp.oh, oh_s + oh_blk); ++oj) {
+            if (!tile_empty(n, g, oj, owb)) {
+                blk_rows[cnt++] = { n, oj };
+                continue;
+            }
+            for (int occ = 0; occ < oc_chunks; ++occ) {
+                int g_ocb = g * jcp.nb_oc + occ * jcp.nb_oc_blocking;
+                fill_skipped_row(dst + dst_d.blk_off(n, g_ocb, oj, ow_s),
+                        dst_c_stride, bias ? bias + g_ocb * jcp.oc_block
+                        : nullptr, ow_len, true, jcp);
+            }
+        }
+        occupied[occupied_off(g, owb, n, ohb)] = cnt;
+    });
 
-            while (start < end) {
-                int ocb = occ * jcp.nb_oc_blocking;
-                int g_ocb = g * jcp.nb_oc + ocb;
-                int g_oc = g_ocb * jcp.oc_block;
-                int g_icb = g * jcp.nb_ic * jcp.nonblk_group_off;
+    /* compact in place: a block never moves towards its own end */
+    auto seg_start = (size_t *)impl::malloc(sizeof(size_t) * (nb_seg + 1), 64);
+    size_t nrows = 0;
+    for (int g = 0; g < jcp.ngroups; ++g)
+    for (int owb = 0; owb < jcp.nb_ow; ++owb) {
+        seg_start[seg_off(g, owb)] = nrows;
+        for (int n = 0; n < jcp.mb; ++n)
+        for (int ohb = 0; ohb < nb_oh; ++ohb) {
+            const int cnt = occupied[occupied_off(g, owb, n, ohb)];
+            const conv_row_t *blk_rows = rows + seg_off(g, owb) * seg_len
+                + (size_t)n * jcp.oh + ohb * oh_blk;
+            if (cnt > 0 && blk_rows != rows + nrows)
+                memmove(rows + nrows, blk_rows, sizeof(conv_row_t) * cnt);
+            nrows += cnt;
+        }
+    }
+    seg_start[nb_seg] = nrows;
+
+    /* runs of a few work items per thread, in whole h blocks */
+    const size_t run_len = nstl::max((size_t)jcp.h_blocking,
+            rnd_up(div_up(nrows * oc_chunks, (size_t)items_per_thr * nthr),
+                (size_t)jcp.h_blocking));
+    const int max_items = oc_chunks * (nb_seg + (int)div_up(nrows, run_len));
+    auto items = (conv_work_item_t *)impl::malloc(
+            sizeof(conv_work_item_t) * max_items, 64);
+    auto wcum = (size_t *)impl::malloc(sizeof(size_t) * (max_items + 1), 64);
+
+    /* items follow the loop order of the kernel, so that neighbouring items
+     * (which usually end up on the same thread) share weights or src */
+    int nitems = 0;
+    wcum[0] = 0;
+    auto add_runs = [&](int g, int occ, int owb) {
+        const size_t r_s = seg_start[seg_off(g, owb)];
+        const size_t r_e = seg_start[seg_off(g, owb) + 1];
+        for (size_t r = r_s; r < r_e; r += run_len) {
+            items[nitems] = { g, occ, owb, r, nstl::min(r_e, r + run_len) };
+            wcum[nitems + 1] = wcum[nitems] + (items[nitems].r_e - r);
+            ++nitems;
+        }
+    };
+    if (jcp.loop_order == loop_cwgn) {
+        for (int occ = 0; occ < oc_chunks; ++occ)
+        for (int owb = 0; owb < jcp.nb_ow; ++owb)
+        for (int g = 0; g < jcp.ngroups; ++g)
+            add_runs(g, occ, owb);
+    } else if (jcp.loop_order == loop_gncw) {
+        for (int g = 0; g < jcp.ngroups; ++g)
+        for (int occ = 0; occ < oc_chunks; ++occ)
+        for (int owb = 0; owb < jcp.nb_ow; ++owb)
+            add_runs(g, occ, owb);
+    } else
+        assert(!"unsupported loop order");
+
+    work_queue_t queue(wcum, nitems, nthr);
+    /* busy time of every thread, including what it stole */
+    auto thr_ns = (int64_t *)impl::malloc(sizeof(int64_t) * nthr, 64);
+    for (int ithr = 0; ithr < nthr; ++ithr)
+        thr_ns[ithr] = 0;
 
-                int work_rem = end - start;
+    parallel(nthr, [&](const int ithr, const int nthr) {
+        const int64_t t_thr = stats_now_ns();
+        auto par_conv = jit_conv_call_s();
+        size_t src_h_stride = src_d.blk_off(0, 0, 1);
+        size_t wht_h_stride = wht_blk_off(weights_d, 0, 0, 0, 1);
 
-                int ow_s =  owb * jcp.ow_block;
-                int iw_s =  ow_s * jcp.stride_w;
-                int oh_e = oh_s + work_rem > jcp.oh ? jcp.oh : oh_s + work_rem;
-                auto bias_w = bias ? bias + g_oc : nullptr;
-                for (int oh_b = oh_s; oh_b < oh_e; oh_b += jcp.h_blocking) {
-                    int ih_b = -jcp.t_pad + oh_b * jcp.stride_h;
-
-                    auto dst_w = dst + dst_d.blk_off(n, g_ocb, oh_b, ow_s);
-                    auto src_w
-                        = src + src_d.blk_off(n, g_icb + icb_l2, ih_b, iw_s);
-                    auto wht_w
-                            = weights + wht_blk_off(weights_d, g, ocb, icb_l2);
+        queue.run(ithr, [&](int iitem) {
+            const auto &w = items[iitem];
+            const int g = w.g, owb = w.owb;
+
+            int ocb = w.occ * jcp.nb_oc_blocking;
+            int g_ocb = g * jcp.nb_oc + ocb;
+            int g_oc = g_ocb * jcp.oc_block;
+            int g_icb = g * jcp.nb_ic * jcp.nonblk_group_off;
+
+            int ow_s =  owb * jcp.ow_block;
+            int iw_s =  ow_s * jcp.stride_w;
+            int ow_len = nstl::min(jcp.ow - ow_s, jcp.ow_block);
+            auto bias_w = bias ? bias + g_oc : nullptr;
+            int col_s{0}, col_e{0};
+            tile_cols(owb, col_s, col_e);
+
+            for (int icb_l2 = 0; icb_l2 < jcp.nb_ic; icb_l2 += jcp.nb_ic_L2) {
+                for (size_t r_b = w.r_s; r_b < w.r_e; r_b += jcp.h_blocking) {
+                    const size_t r_e
+                        = nstl::min(w.r_e, r_b + (size_t)jcp.h_blocking);
                     for (int icb = icb_l2;
                             icb < min(jcp.nb_ic, icb_l2 + jcp.nb_ic_L2);
                             ++icb) {
-                        auto src_c = src_w;
-                        auto dst_c = dst_w;
-                        for (int oj = oh_b, ij = ih_b;
-                                oj < min(oh_e, oh_b + jcp.h_blocking);
-                                ++oj, ij += jcp.stride_h) {
-
-                            int dilate_h = jcp.dilate_h + 1;
-                            int i_t_overflow = div_up(max(0, -ij), dilate_h);
-                            int i_b_overflow = div_up(max(0, ij - jcp.ih
-                                + (jcp.kh - 1) * dilate_h + 1), dilate_h);
-                            int kh_padding = nstl::max(
-                                    0, jcp.kh - i_t_overflow - i_b_overflow);
-
-                            auto aux_src = src_c
-                                    + i_t_overflow * dilate_h * src_h_stride;
-                            auto aux_wht = wht_w + i_t_overflow * wht_h_stride;
-                            //Sparsity Check ----SparseConvolution
-                            int num = 0;
-                            int i = 0;
-                            for(; i <int(src_h_stride) * kh_padding; i++){
-                            if(aux_src[i] != 0 ){
-                              num++;
-                            }
-                          }
-                          
-                          if(num >= 1){
-                            jit_conv_ker_pipeline_ow_thr(kernel_->jit_ker,
-                                par_conv, aux_src, dst_c, aux_wht, bias_w, icb,
-                                kh_padding, owb);}
-
-                            src_c += src_h_stride * jcp.stride_h;
-                            dst_c += dst_h_stride;
+                        auto wht_c
+                            = weights + wht_blk_off(weights_d, g, ocb, icb);
+                        for (size_t r = r_b; r < r_e; ++r) {
+                            const int n = rows[r].n, oj = rows[r].oj;
+                            int ij = -jcp.t_pad + oj * jcp.stride_h;
+                            int i_t_overflow, kh_padding;
+                            row_rf(ij, i_t_overflow, kh_padding);
+                            auto dst_c
+                                = dst + dst_d.blk_off(n, g_ocb, oj, ow_s);
+
+                            /* Every listed tile is occupied in some icb.
+                             * The first icb pass writes what the kernel
+                             * would have (bias or zero) for the icbs that
+                             * are empty, and the last one is kept when the
+                             * tile still needs its eltwise post-op. */
+                            int ij_s = ij + i_t_overflow * dilate_h;
+                            bool skip = !src_occ.any(n, g * jcp.nb_ic + icb,
+                                    ij_s, kh_padding, dilate_h, col_s, col_e);
+                            if (skip && jcp.with_eltwise
+                                    && icb == jcp.nb_ic - 1)
+                                skip = false;
+
+                            if (!skip)
+                                jit_conv_ker_pipeline_ow_thr(kernel_->jit_ker,
+                                    par_conv,
+                                    src + src_d.blk_off(n, g_icb + icb, 0,
+                                        iw_s) + ij_s * src_h_stride,
+                                    dst_c, wht_c + i_t_overflow * wht_h_stride,
+                                    bias_w, icb, kh_padding, owb);
+                            else if (icb == 0)
+                                fill_skipped_row(dst_c, dst_c_stride, bias_w,
+                                        ow_len, false, jcp);
                         }
-                        src_w += src_c_stride;
-                        wht_w += wht_ic_stride;
                     }
                 }
-
-                if (jcp.loop_order == loop_cwgn)
-                    nd_iterator_jump(start, end, occ, oc_chunks, owb, jcp.nb_ow,
-                        g, jcp.ngroups, n, jcp.mb, oh_s, jcp.oh);
-                else if (jcp.loop_order == loop_gncw)
-                    nd_iterator_jump(start, end, g, jcp.ngroups, n, jcp.mb, occ,
-                        oc_chunks, owb, jcp.nb_ow, oh_s, jcp.oh);
-                else
-                    assert(!"unsupported loop order");
             }
-        }
+        });
 
         jit_conv_ker_pipeline_ow_thr(kernel_->jit_ker, par_conv,
                 src, dst, weights, bias, 0, 0, 0);
+        thr_ns[ithr] = stats_now_ns() - t_thr;
     });
+
+    const int64_t t_end = stats_now_ns();
+    int64_t thr_max = 0, thr_sum = 0;
+    for (int ithr = 0; ithr < nthr; ++ithr) {
+        thr_max = nstl::max(thr_max, thr_ns[ithr]);
+        thr_sum += thr_ns[ithr];
+    }
+    auto &stats = sparse_conv_stats;
+    stats.calls += 1;
+    stats.rows += (int64_t)nb_seg * seg_len;
+    stats.rows_skipped += (int64_t)(nb_seg * seg_len - nrows);
+    stats.scan_ns += t_kernel - t_scan;
+    stats.kernel_ns += t_end - t_kernel;
+    stats.thr_max_ns += thr_max;
+    stats.thr_avg_ns += thr_sum / nthr;
+
+    impl::free(thr_ns);
+    impl::free(wcum);
+    impl::free(items);
+    impl::free(seg_start);
+    impl::free(rows);
+    impl::free(occupied);
 }
 
 template <data_type_t src_type, data_type_t wei_type,
@@ -385,6 +1002,31 @@ void jit_avx512_common_convolution_fwd_t
     const auto &jcp = kernel_->jcp;
     assert(jcp.nb_oc % jcp.nb_oc_blocking == 0);
 
+    /* rows of all depth slices are stacked: row (d, h) is d * ih + h */
+    row_occupancy_t src_occ(jcp.mb, jcp.ngroups, jcp.nb_ic, jcp.id * jcp.ih,
+            jcp.iw);
+    src_occ.init(src,
+            [&](int n, int c, int r) {
+                return src_d.blk_off(n, c, r / jcp.ih, r % jcp.ih);
+            }, src_d.blk_off(0, 0, 0, 0, 1), jcp.ic_block,
+            jcp.is_1stconv, true);
+    const size_t dst_c_stride = dst_d.blk_off(0, 1);
+
+    const int dilate_d = jcp.dilate_d + 1;
+    const int dilate_h = jcp.dilate_h + 1;
+    /* checks the kd_len x kh_len receptive field starting at (d_s, h_s) of
+     * channel block `c` or, with `c` < 0, of the whole group `g` */
+    auto rf_any = [&](int n, int g, int c, int d_s, int kd_len, int h_s,
+            int kh_len, int h_step) {
+        for (int kd = 0; kd < kd_len; ++kd) {
+            int r = (d_s + kd * dilate_d) * jcp.ih + h_s;
+            if (c < 0 ? src_occ.any_in_group(n, g, r, kh_len, h_step)
+                    : src_occ.any(n, c, r, kh_len, h_step))
+                return true;
+        }
+        return false;
+    };
+
     parallel(0, [&](const int ithr, const int nthr) {
         int oc_chunks = jcp.nb_oc / jcp.nb_oc_blocking;
         int start{0}, end{0}, start_copy;
@@ -430,8 +1072,8 @@ void jit_avx512_common_convolution_fwd_t
                 int oh_e = oh_s + work_rem > jcp.oh ? jcp.oh : oh_s + work_rem;
 
                 int id_s = -jcp.f_pad + od_s * jcp.stride_d;
+                int ow_len = nstl::min(jcp.ow - ow_s, jcp.ow_block);
 
-                int dilate_d = jcp.dilate_d + 1;
                 int d_t_overflow = div_up(max(0, -id_s), dilate_d);
                 int d_b_overflow = div_up(
                         max(0, id_s - jcp.id + (jcp.kd - 1) * dilate_d + 1),
@@ -446,14 +1088,21 @@ void jit_avx512_common_convolution_fwd_t
                 auto wht_w = weights + wht_blk_off(weights_d, g, ocb, icb_l2)
                     + d_t_overflow * wht_d_stride;
 
+                /* A depth slice whose whole kd window is empty is finalized
+                 * on the first icb_l2 pass and skipped afterwards. Rows of
+                 * other slices are skipped as in execute_forward_2d(). */
+                int id_d = id_s + d_t_overflow * dilate_d;
+                bool slice_empty = !rf_any(n, g, -1, id_d, kd_padding, 0,
+                        jcp.ih, 1);
+
                 for (int icb = icb_l2;
-                     icb < min(jcp.nb_ic, icb_l2 + jcp.nb_ic_L2); ++icb) {
+                     icb < min(jcp.nb_ic, icb_l2 + jcp.nb_ic_L2)
+                     && !slice_empty; ++icb) {
                     auto src_c = src_w;
                     auto dst_c = dst_w;
                     for (int oj = oh_s, ij = ih_s;
                             oj < oh_e; ++oj, ij += jcp.stride_h)
                     {
-                        int dilate_h = jcp.dilate_h + 1;
                         int i_t_overflow = div_up(max(0, -ij), dilate_h);
                         int i_b_overflow = div_up(
                                 max(0, ij - jcp.ih + (jcp.kh - 1) * dilate_h
@@ -461,11 +1110,26 @@ void jit_avx512_common_convolution_fwd_t
                                 dilate_h);
                         int kh_padding = nstl::max(0,
                             jcp.kh - i_t_overflow - i_b_overflow);
-                        jit_conv_3d_ker_pipeline_ow_thr(kernel_->jit_ker,
-                            par_conv,
-                            src_c + i_t_overflow * dilate_h * src_h_stride,
-                            dst_c, wht_w + i_t_overflow * wht_h_stride,
-                            bias_w, icb, kh_padding, kd_padding, owb);
+
+                        int ij_s = ij + i_t_overflow * dilate_h;
+                        bool row_empty = !rf_any(n, g, -1, id_d, kd_padding,
+                                ij_s, kh_padding, dilate_h);
+                        bool skip = row_empty || !rf_any(n, g,
+                                g * jcp.nb_ic + icb, id_d, kd_padding, ij_s,
+                                kh_padding, dilate_h);
+                        if (skip && !row_empty && jcp.with_eltwise
+                                && icb == jcp.nb_ic - 1)
+                            skip = false;
+
+                        if (!skip)
+                            jit_conv_3d_ker_pipeline_ow_thr(kernel_->jit_ker,
+                                par_conv,
+                                src_c + i_t_overflow * dilate_h * src_h_stride,
+                                dst_c, wht_w + i_t_overflow * wht_h_stride,
+                                bias_w, icb, kh_padding, kd_padding, owb);
+                        else if (icb == 0)
+                            fill_skipped_row(dst_c, dst_c_stride, bias_w,
+                                    ow_len, row_empty, jcp);
 
                         src_c += src_h_stride * jcp.stride_h;
                         dst_c += dst_h_stride;
@@ -474,6 +1138,13 @@ void jit_avx512_common_convolution_fwd_t
                     wht_w += wht_ic_stride;
                 }
 
+                if (slice_empty && icb_l2 == 0) {
+                    auto dst_c = dst_w;
+                    for (int oj = oh_s; oj < oh_e; ++oj, dst_c += dst_h_stride)
+                        fill_skipped_row(dst_c, dst_c_stride, bias_w, ow_len,
+                                true, jcp);
+                }
+
                 if (jcp.loop_order == loop_cwgn)
                     nd_iterator_jump(start, end,
                       occ, oc_chunks, owb, jcp.nb_ow, g, jcp.ngroups, n, jcp.mb,
@@ -588,6 +1259,13 @@ void jit_avx512_common_convolution_bwd_data_t<diff_dst_type, wei_type,
 
     const auto &jcp = kernel_->jcp;
 
+    /* zero rows of diff_dst contribute nothing to diff_src */
+    row_occupancy_t diff_dst_occ(jcp.mb, jcp.ngroups, jcp.nb_oc, jcp.oh,
+            jcp.ow);
+    diff_dst_occ.init(diff_dst,
+            [&](int n, int c, int r) { return diff_dst_d.blk_off(n, c, r); },
+            diff_dst_d.blk_off(0, 0, 0, 1), jcp.oc_block, false);
+
     parallel(0, [&](const int ithr, const int nthr) {
         int start{0}, end{0}, start_copy;
         int ic_chunks = jcp.nb_ic / jcp.nb_ic_blocking;
@@ -597,12 +1275,15 @@ void jit_avx512_common_convolution_bwd_data_t<diff_dst_type, wei_type,
 
         auto par_conv = jit_conv_call_s();
         size_t diff_src_h_stride = diff_src_d.blk_off(0, 0, 1);
+        size_t diff_src_c_stride = diff_src_d.blk_off(0, 1);
         size_t diff_dst_h_stride = diff_dst_d.blk_off(0, 0, 1);
         size_t diff_dst_c_stride = diff_dst_d.blk_off(0, 1);
         size_t wht_h_stride = wht_blk_off(weights_d, 0, 0, 0, 1);
         size_t wht_oc_stride = wht_blk_off(weights_d, 0, 1);
 
         bool is_fast_path = jcp.dilate_h == 0 && jcp.stride_h == 1;
+        /* distance between the diff_dst rows the kernel visits */
+        int oj_step = jcp.dilate_h != 0 ? jcp.dilate_h + 1 : 1;
 
         for (int ocb_l2 = 0; ocb_l2 < jcp.nb_oc; ocb_l2 += jcp.nb_oc_L2) {
             start = start_copy;
@@ -671,11 +1352,23 @@ void jit_avx512_common_convolution_bwd_data_t<diff_dst_type, wei_type,
                         }
                         assert(k_len >= 0);
 
-                        jit_conv_ker_pipeline(kernel_->jit_ker, par_conv,
-                                diff_src_w + ij * diff_src_h_stride,
-                                diff_dst_w + oj * diff_dst_h_stride,
-                                wht_w + k_lo * wht_h_stride,
-                                0, ocb, k_len);
+                        /* The kernel walks diff_dst up from row oj. If all
+                         * those rows are zero the call is skipped, and the
+                         * first ocb pass zeroes the diff_src row instead. */
+                        if (diff_dst_occ.any(n, g_ocb + ocb,
+                                    oj - (k_len - 1) * oj_step, k_len,
+                                    oj_step))
+                            jit_conv_ker_pipeline(kernel_->jit_ker, par_conv,
+                                    diff_src_w + ij * diff_src_h_stride,
+                                    diff_dst_w + oj * diff_dst_h_stride,
+                                    wht_w + k_lo * wht_h_stride,
+                                    0, ocb, k_len);
+                        else if (ocb == 0)
+                            for (int ib = 0; ib < jcp.nb_ic_blocking; ++ib)
+                                array_set(diff_src_w + ib * diff_src_c_stride
+                                        + ij * diff_src_h_stride,
+                                        (diff_src_data_t)0,
+                                        (size_t)jcp.iw * jcp.ic_block);
                     }
                     diff_dst_w += diff_dst_c_stride;
                     wht_w += wht_oc_stride;
@@ -935,6 +1628,10 @@ struct jit_avx512_common_convolution_bwd_weights_t<src_type, diff_dst_type,
     int oc_b_start = 0, oc_b_end = 0, oc_b_work;
     int ic_b_start = 0, ic_b_end = 0, ic_b_work;
 
+    /* occupancy of src and diff_dst (1D and 2D only) */
+    const row_occupancy_t *src_occ = nullptr;
+    const row_occupancy_t *diff_dst_occ = nullptr;
+
     thread_info_t(const jit_avx512_common_convolution_bwd_weights_t *self,
             int ithr): scratchpad(self->scratchpad()), ithr(ithr) {
         src = reinterpret_cast<const src_data_t *>(self->input_memory(0));
@@ -1253,6 +1950,18 @@ void jit_avx512_common_convolution_bwd_weights_t<src_type, diff_dst_type,
                 const int _oc = g * jcp.nb_oc + oc_b;
                 const int _ic = g * jcp.nb_ic + ic_b;
 
+                /* an all-zero src or diff_dst plane adds nothing to the
+                 * weights gradient, the first image only has to zero it */
+                if (!ti->src_occ->any(img, _ic)
+                        || !ti->diff_dst_occ->any(img, _oc)) {
+                    if (img == ti->img_start)
+                        array_set(diff_wei + wht_blk_off(diff_weights_d, g,
+                                    oc_b, ic_b), (diff_weights_data_t)0,
+                                (size_t)jcp.kh * jcp.kw * jcp.ic_block
+                                * jcp.oc_block);
+                    continue;
+                }
+
                 jit_conv_ker_pipeline(kernel_->jit_ker, p,
                          (utils::one_of(jcp.ver, ver_4fma, ver_4vnni, ver_vnni)
                          ? &ti->tr_src[tr_src_off(ti->ithr_mb, _ic, 0)]
@@ -1610,10 +2319,40 @@ void jit_avx512_common_convolution_bwd_weights_t<src_type, diff_dst_type,
     diff_weights_type>::execute_backward_weights() const {
     prepare_scratchpad_data();
 
+    const auto &jcp = kernel_->jcp;
+    const bool is_1d = pd()->ndims() == 3;
+    const int occ_mb = utils::one_of(pd()->ndims(), 3, 4) ? jcp.mb : 0;
+
+    row_occupancy_t src_occ(occ_mb, jcp.ngroups, jcp.nb_ic,
+            is_1d ? 1 : jcp.ih, jcp.iw);
+    row_occupancy_t diff_dst_occ(occ_mb, jcp.ngroups, jcp.nb_oc,
+            is_1d ? 1 : jcp.oh, jcp.ow);
+    if (occ_mb > 0) {
+        const memory_desc_wrapper src_d(pd()->src_pd(0));
+        const memory_desc_wrapper diff_dst_d(pd()->diff_dst_pd());
+        auto src = reinterpret_cast<const src_data_t *>(this->input_memory(0));
+        auto diff_dst = reinterpret_cast<const diff_dst_data_t *>(
+                this->input_memory(1));
+
+        src_occ.init(src,
+                [&](int n, int c, int r) {
+                    return is_1d ? src_d.blk_off(n, c) : src_d.blk_off(n, c, r);
+                }, is_1d ? src_d.blk_off(0, 0, 1) : src_d.blk_off(0, 0, 0, 1),
+                jcp.ic_block, jcp.is_1stconv, true);
+        diff_dst_occ.init(diff_dst,
+                [&](int n, int c, int r) {
+                    return is_1d ? diff_dst_d.blk_off(n, c)
+                        : diff_dst_d.blk_off(n, c, r);
+                }, is_1d ? diff_dst_d.blk_off(0, 0, 1)
+                : diff_dst_d.blk_off(0, 0, 0, 1), jcp.oc_block, false);
+    }
+
     parallel(nthr_, [&](const int ithr, const int nthr) {
         assert(nthr_ == nthr);
 
         thread_info_t thread_info(this, ithr);
+        thread_info.src_occ = &src_occ;
+        thread_info.diff_dst_occ = &diff_dst_occ;
 
         if (utils::one_of(pd()->ndims(), 3, 4)) {
             compute_diff_weights(&thread_info);
@@ -1647,4 +2386,45 @@ template struct jit_avx512_common_convolution_bwd_weights_t<data_type::s16,
 }
 }
 
+using namespace mkldnn::impl;
+using namespace mkldnn::impl::status;
+
+/* Sets how the convolutions executed on the calling thread find empty input
+ * rows: 0 - dense, no skipping; 1 - scan the input (the default); 2 - take
+ * them from `row_mask`, an mb x nrows byte array (nrows = id * ih, or 1 for
+ * 1D) with non-zero entries for occupied rows of the source. A mask whose
+ * shape does not match the convolution falls back to scanning. The mask is
+ * not copied and must outlive every execution until the hint is reset. */
+extern "C" mkldnn_status_t MKLDNN_API mkldnn_sparse_conv_set_hint(int mode,
+        const uint8_t *row_mask, int mb, int nrows) {
+    using namespace mkldnn::impl::cpu;
+    bool args_ok = utils::one_of(mode, sparse_conv_dense, sparse_conv_scan,
+            sparse_conv_row_mask)
+        && IMPLICATION(mode == sparse_conv_row_mask,
+                row_mask != nullptr && mb > 0 && nrows > 0);
+    if (!args_ok) return invalid_arguments;
+
+    sparse_conv_hint = { mode, row_mask, mb, nrows };
+    return success;
+}
+
+/* Returns the counters of the 2D forward executions of the calling thread
+ * since the previous call and resets them. `stats` points to 7 int64_t:
+ * executions, output row tiles, skipped (all-zero receptive field) tiles,
+ * ns spent building the occupancy, ns in the compute region, and the sums
+ * over the executions of the busiest and of the average thread's ns. */
+extern "C" mkldnn_status_t MKLDNN_API mkldnn_sparse_conv_get_stats(
+        int64_t *stats) {
+    using namespace mkldnn::impl::cpu;
+    if (stats == nullptr) return invalid_arguments;
+
+    const auto &s = sparse_conv_stats;
+    const int64_t values[] = { s.calls, s.rows, s.rows_skipped, s.scan_ns,
+        s.kernel_ns, s.thr_max_ns, s.thr_avg_ns };
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i)
+        stats[i] = values[i];
+    sparse_conv_stats = {};
+    return success;
+}
+
 // vim: et ts=4 sw=4 cindent cino^=l0,\:0,N-s
@@ -12,6 +12,7 @@ skipIfNoTorchVision = unittest.skipIf(not HAS_TORCHVISION, "no torchvision")
 
 import torch
 import torch.jit
+import torch.backends.mkldnn
 from torch.utils import mkldnn as mkldnn_utils
 from common_utils import TestCase, run_tests, TemporaryFileName
 
@@ -122,6 +123,289 @@ class TestMkldnn(TestCase):
                 self._test_serialization(mkldnn_conv2d, (x.to_mkldnn(),))
                 self._test_tracing(mkldnn_conv2d, (x.to_mkldnn(),))
 
+    def test_conv2d_weight_update(self):
+        x = torch.randn(2, 16, 16, 16, dtype=torch.float32)
+        for groups in [1, 4]:
+            conv2d = torch.nn.Conv2d(16, 32, 3, padding=1, groups=groups).float()
+            args = ([1, 1], [1, 1], [1, 1], groups)
+
+            def check():
+                # the double convolution does not go through MKL-DNN
+                expected = torch.conv2d(x.double(), conv2d.weight.double(), conv2d.bias.double(),
+                                        padding=1, groups=groups).float()
+                y = torch.mkldnn_convolution(x, conv2d.weight, conv2d.bias, *args)
+                self.assertEqual(expected, y)
+                return y
+
+            with torch.no_grad():
+                y1 = check()
+            # updates through .data, as the optimizers do, share no version counter
+            conv2d.weight.data.add_(1)
+            with torch.no_grad():
+                y2 = check()
+            self.assertNotEqual(y1, y2)
+
+            # the weight is reordered once by to_mkldnn and reused by every call
+            mkldnn_conv2d = mkldnn_utils.to_mkldnn(copy.deepcopy(conv2d))
+            with torch.no_grad():
+                self.assertEqual(y2, mkldnn_conv2d(x.to_mkldnn()).to_dense())
+                self.assertEqual(y2, mkldnn_conv2d(x.to_mkldnn()).to_dense())
+
+    def test_conv2d_relu(self):
+        x = torch.randn(2, 16, 32, 32, dtype=torch.float32)
+        x[:, :, 10:] = 0
+        for groups in [1, 4]:
+            conv2d = torch.nn.Conv2d(16, 32, 3, padding=1, groups=groups).float()
+            args = (conv2d.weight, conv2d.bias, [1, 1], [1, 1], [1, 1], groups)
+            expected = torch.relu(conv2d(x))
+            other = torch.randn_like(expected)
+            expected_sum = torch.relu(conv2d(x) + other)
+            for sparse_conv in [False, True]:
+                with torch.backends.mkldnn.flags(sparse_conv=sparse_conv):
+                    self.assertEqual(expected, torch.mkldnn_convolution_relu(x, *args))
+                    self.assertEqual(expected, torch.mkldnn_convolution_relu(x.to_mkldnn(), *args).to_dense())
+                    self.assertEqual(expected_sum, torch.mkldnn_convolution_sum_relu(
+                        x, conv2d.weight, conv2d.bias, other, [1, 1], [1, 1], [1, 1], groups))
+                    self.assertEqual(expected_sum, torch.mkldnn_convolution_sum_relu(
+                        x.to_mkldnn(), conv2d.weight, conv2d.bias, other.to_mkldnn(),
+                        [1, 1], [1, 1], [1, 1], groups).to_dense())
+
+        with self.assertRaisesRegex(RuntimeError, "expected other of size"):
+            torch.mkldnn_convolution_sum_relu(x, conv2d.weight, conv2d.bias, other[:, :, :16],
+                                              [1, 1], [1, 1], [1, 1], groups)
+
+        # to_mkldnn fuses a ReLU following a Conv2d in a Sequential
+        model = torch.nn.Sequential(conv2d, torch.nn.ReLU(), torch.nn.Conv2d(32, 8, 1)).float()
+        mkldnn_model = mkldnn_utils.to_mkldnn(copy.deepcopy(model))
+        self.assertTrue(mkldnn_model[0].fuse_relu)
+        self.assertIsInstance(mkldnn_model[1], torch.nn.Identity)
+        self.assertEqual(model(x), mkldnn_model(x.to_mkldnn()).to_dense())
+        self._test_serialization(mkldnn_model[0], (x.to_mkldnn(),))
+
+    def test_conv2d_dilated_transposed(self):
+        x = torch.randn(2, 8, 20, 20, dtype=torch.float32)
+        x[:, :, :12] = 0
+        for groups in [1, 2]:
+            modules = [
+                torch.nn.Conv2d(8, 16, 3, padding=2, dilation=2, groups=groups),
+                torch.nn.ConvTranspose2d(8, 16, 3, stride=2, padding=1, groups=groups),
+                torch.nn.ConvTranspose2d(8, 16, 3, stride=2, padding=1, output_padding=1, groups=groups),
+                torch.nn.ConvTranspose2d(8, 16, 3, stride=3, padding=2, dilation=2, output_padding=1, groups=groups),
+                # output_padding does not fit in the stride: falls back to THNN
+                torch.nn.ConvTranspose2d(8, 16, 3, stride=1, padding=2, dilation=2, output_padding=1, groups=groups),
+            ]
+            for module in modules:
+                module = module.float()
+                # the double convolution does not go through MKL-DNN
+                module_ref = copy.deepcopy(module).double()
+                for sparse_conv in [False, True]:
+                    inp = x.clone().requires_grad_()
+                    inp_ref = x.double().requires_grad_()
+                    with torch.backends.mkldnn.flags(sparse_conv=sparse_conv), \
+                            torch.autograd.profiler.profile() as prof:
+                        y = module(inp)
+                    on_mkldnn = any(evt.name.startswith('mkldnn_convolution')
+                                    for evt in prof.function_events)
+                    fits_stride = all(p < s for p, s in zip(module.output_padding, module.stride))
+                    self.assertEqual(on_mkldnn, fits_stride,
+                                     "{} {} on MKL-DNN".format(module, "did not run" if fits_stride else "ran"))
+                    y_ref = module_ref(inp_ref)
+                    self.assertEqual(y_ref, y.double(), prec=1e-4)
+                    grad = torch.randn_like(y_ref)
+                    y.backward(grad.float())
+                    y_ref.backward(grad)
+                    self.assertEqual(inp_ref.grad, inp.grad.double(), prec=1e-4)
+                    self.assertEqual(module_ref.weight.grad, module.weight.grad.double(), prec=1e-3)
+                    self.assertEqual(module_ref.bias.grad, module.bias.grad.double(), prec=1e-3)
+                    module.zero_grad()
+                    module_ref.zero_grad()
+
+    def test_conv2d_delta(self):
+        conv2d = torch.nn.Conv2d(16, 8, 3, padding=1).float()
+        args = (conv2d.weight, conv2d.bias, [1, 1], [1, 1], [1, 1], 1)
+        frames = [torch.randn(1, 16, 32, 24, dtype=torch.float32)]
+        for rows in [slice(3, 5), slice(20, 21), slice(0, 0)]:
+            frame = frames[-1].clone()
+            frame[:, :, rows] = torch.randn_like(frame[:, :, rows])
+            frames.append(frame)
+
+        for to_mkldnn in [False, True]:
+            def convert(t):
+                return t.to_mkldnn() if to_mkldnn else t
+
+            def to_dense(t):
+                return t.to_dense() if to_mkldnn else t
+
+            prev_input, prev_output = None, None
+            for frame in frames:
+                y = torch.mkldnn_convolution_delta(convert(frame), *args,
+                                                   prev_input=prev_input, prev_output=prev_output)
+                self.assertEqual(conv2d(frame), to_dense(y), prec=1e-4)
+                prev_input, prev_output = convert(frame), y
+
+        with self.assertRaisesRegex(RuntimeError, "both prev_input and prev_output"):
+            torch.mkldnn_convolution_delta(frames[1], *args, prev_input=frames[0])
+        with self.assertRaisesRegex(RuntimeError, "expected prev_input of size"):
+            torch.mkldnn_convolution_delta(frames[1], *args, prev_input=frames[0][:, :, 1:],
+                                           prev_output=conv2d(frames[0]))
+
+    def test_conv2d_nhwc(self):
+        # a stem convolution on uint8 frames with a few non-black rows
+        conv2d = torch.nn.Conv2d(3, 64, 7, stride=2, padding=3).float()
+        args = (conv2d.weight, conv2d.bias, [3, 3], [2, 2], [1, 1], 1)
+        frames = torch.zeros(2, 40, 32, 3, dtype=torch.uint8)
+        frames[0, 10:14] = torch.randint(0, 256, (4, 32, 3), dtype=torch.uint8)
+        frames[1, 30:31, 5:9] = torch.randint(0, 256, (1, 4, 3), dtype=torch.uint8)
+        mean = torch.tensor([0.485, 0.456, 0.406])
+        std = torch.tensor([0.229, 0.224, 0.225])
+
+        x = frames.permute(0, 3, 1, 2).float() / 255
+        self.assertEqual(
+            conv2d(x),
+            torch.mkldnn_convolution_nhwc(frames, *args, scale=1. / 255),
+            prec=1e-4)
+        self.assertEqual(
+            conv2d(x),
+            torch.mkldnn_convolution_nhwc(frames.float() / 255, *args),
+            prec=1e-4)
+        self.assertEqual(
+            conv2d((x - mean.view(1, 3, 1, 1)) / std.view(1, 3, 1, 1)),
+            torch.mkldnn_convolution_nhwc(frames, *args, scale=1. / 255, mean=mean, std=std),
+            prec=1e-4)
+
+        # channels that fill the blocked layout
+        conv2d = torch.nn.Conv2d(16, 8, 3, padding=1).float()
+        x = torch.zeros(1, 12, 10, 16)
+        x[:, 4:6] = torch.randn(1, 2, 10, 16)
+        self.assertEqual(
+            conv2d(x.permute(0, 3, 1, 2)),
+            torch.mkldnn_convolution_nhwc(x, conv2d.weight, conv2d.bias, [1, 1], [1, 1], [1, 1], 1),
+            prec=1e-4)
+
+    def test_conv2d_sparse(self):
+        for groups in [1, 4]:
+            N = torch.randint(3, 10, (1,)).item()
+            C = torch.randint(1, 3, (1,)).item() * groups
+            M = torch.randint(1, 3, (1,)).item() * groups
+            x = torch.randn(N, C, 64, 64, dtype=torch.float32) * 100
+            # a band of occupied rows per image, the rest is background
+            mask = torch.zeros(N, 64, 64, dtype=torch.uint8)
+            for n in range(N):
+                h = torch.randint(0, 48, (1,)).item()
+                mask[n, h:h + 16] = 1
+            x = x * mask.unsqueeze(1).float()
+            for bias in [True, False]:
+                conv2d = torch.nn.Conv2d(in_channels=C,
+                                         out_channels=M,
+                                         kernel_size=3,
+                                         stride=1,
+                                         padding=1,
+                                         bias=bias,
+                                         groups=groups).float()
+                expected = conv2d(x)
+                args = (conv2d.weight, conv2d.bias, [1, 1], [1, 1], [1, 1], groups)
+                self.assertEqual(expected, torch.mkldnn_convolution_sparse(x, *args))
+                self.assertEqual(expected, torch.mkldnn_convolution_sparse(x, *args, row_mask=mask))
+                self.assertEqual(expected, torch.mkldnn_convolution_sparse(x, *args, row_mask=mask.any(2)))
+                with torch.backends.mkldnn.flags(sparse_conv=True):
+                    self.assertTrue(torch.backends.mkldnn.sparse_conv)
+                    self.assertEqual(expected, torch.mkldnn_convolution(x, *args))
+                self.assertFalse(torch.backends.mkldnn.sparse_conv)
+
+        with self.assertRaisesRegex(RuntimeError, "row mask of shape"):
+            torch.mkldnn_convolution_sparse(x, *args, row_mask=mask[:, :32])
+
+    @unittest.skipIf(not torch.backends.mkldnn.is_sparse_conv_available(),
+                     "MKL-DNN is built without sparse convolution support")
+    def test_conv2d_sparse_profiler(self):
+        conv2d = torch.nn.Conv2d(16, 16, kernel_size=3, padding=1).float()
+        args = (conv2d.weight, conv2d.bias, [1, 1], [1, 1], [1, 1], 1)
+        x = torch.zeros(2, 16, 32, 32, dtype=torch.float32)
+        x[:, :, 4:6] = torch.randn(2, 16, 2, 32)
+        with torch.autograd.profiler.profile() as prof:
+            torch.mkldnn_convolution_sparse(x, *args)
+        events = [evt for evt in prof.function_events if evt.counters]
+        # the sparse kernel reports counters once, on the innermost op
+        self.assertEqual(len(events), 1)
+        evt = events[0]
+        self.assertEqual(evt.name, 'mkldnn_convolution_sparse')
+        counters = evt.counters
+        self.assertEqual(counters['sparse_conv_calls'], 1)
+        self.assertGreater(counters['rows_skipped'], 0)
+        self.assertLess(counters['rows_skipped'], counters['rows_visited'])
+        self.assertGreaterEqual(counters['thread_imbalance'], 1)
+
+    def test_conv2d_sparse_dispatch(self):
+        conv2d = torch.nn.Conv2d(4, 8, kernel_size=3, padding=1).float()
+        x = torch.randn(2, 4, 64, 64, dtype=torch.float32)
+        x_sparse = x.clone()
+        x_sparse[:, :, 8:] = 0
+        for threshold in [0., 0.5, 1.1]:
+            with torch.backends.mkldnn.flags(sparse_conv=True, sparse_conv_threshold=threshold):
+                self.assertEqual(torch.backends.mkldnn.sparse_conv_threshold, threshold)
+                for inp in [x, x_sparse]:
+                    inp = inp.clone().requires_grad_()
+                    inp_ref = inp.detach().clone().requires_grad_()
+                    y = conv2d(inp)
+                    with torch.backends.mkldnn.flags(sparse_conv=False):
+                        y_ref = conv2d(inp_ref)
+                    self.assertEqual(y_ref, y)
+                    y.sum().backward()
+                    y_ref.sum().backward()
+                    self.assertEqual(inp_ref.grad, inp.grad)
+
+    def test_conversion_row_mask(self):
+        N, C, H, W = 2, 16, 24, 8
+        x = torch.randn(N, C, H, W, dtype=torch.float32)
+        x[0, :, :10] = 0
+        x[1, :, 5:] = 0
+        x[1, 3, 7, 2] = 1.
+        expected_rows = x.ne(0).any(3).any(1).to(torch.uint8)
+        with torch.backends.mkldnn.flags(sparse_conv=True):
+            x_mkldnn = x.to_mkldnn()
+            self.assertEqual(expected_rows, torch._mkldnn_row_mask(x_mkldnn))
+            self.assertEqual(x, x_mkldnn.to_dense())
+
+            # dense inputs of the sparse convolution take the same path
+            conv2d = torch.nn.Conv2d(C, 8, 3, padding=1).float()
+            args = (conv2d.weight, conv2d.bias, [1, 1], [1, 1], [1, 1], 1)
+            self.assertEqual(conv2d(x), torch.mkldnn_convolution_sparse(x, *args))
+
+    def test_row_mask_propagation(self):
+        N, C, H, W = 2, 4, 32, 16
+        x = torch.randn(N, C, H, W, dtype=torch.float32)
+        mask = torch.zeros(N, H, dtype=torch.uint8)
+        mask[0, 4:8] = 1
+        mask[1, 20:30] = 1
+        x = x * mask.view(N, 1, H, 1).float()
+
+        conv1 = torch.nn.Conv2d(C, 8, 3, padding=1, bias=False).float()
+        bn = torch.nn.BatchNorm2d(8).float().eval()
+        bn.running_mean.uniform_(-1, 1)
+        bn.running_var.uniform_(0.5, 2)
+        pool = torch.nn.MaxPool2d(2)
+        conv2 = torch.nn.Conv2d(8, 8, 3, padding=1).float()
+        model = torch.nn.Sequential(conv1, bn, torch.nn.ReLU(), pool, conv2, torch.nn.ReLU())
+        expected = model(x)
+
+        mkldnn_model = mkldnn_utils.to_mkldnn(copy.deepcopy(model))
+        x_mkldnn = torch._mkldnn_set_row_mask_(x.to_mkldnn(), mask)
+        self.assertEqual(mask, torch._mkldnn_row_mask(x_mkldnn))
+        with torch.backends.mkldnn.flags(sparse_conv=True, sparse_conv_threshold=1.1):
+            y = mkldnn_model(x_mkldnn)
+        self.assertEqual(expected, y.to_dense())
+
+        # the propagated mask covers every row that is not background
+        rows = torch._mkldnn_row_mask(mkldnn_model[:4](x_mkldnn))
+        self.assertEqual(rows.shape, (N, H // 2))
+        self.assertEqual(rows[0, :1].sum(), 0)
+        self.assertEqual(rows[0, 2:4].sum(), 2)
+        self.assertEqual(rows[1, 9:16].sum(), 7)
+
+        # ops that cannot track the rows drop them
+        self.assertIsNone(torch._mkldnn_row_mask(x.to_mkldnn()))
+        self.assertIsNone(torch._mkldnn_row_mask(torch._mkldnn_set_row_mask_(x.to_mkldnn(), mask).zero_()))
+
     def test_relu(self):
         x = torch.randn((4, 5), dtype=torch.float32) * 10
         self.assertEqual(torch.relu(x), torch.relu(x.to_mkldnn()).to_dense())
@@ -131,6 +415,11 @@ class TestMkldnn(TestCase):
         x2 = x1.clone().to_mkldnn()
         self.assertEqual(torch.relu_(x1), torch.relu_(x2).to_dense())
 
+    def test_relu_1d(self):
+        x = torch.randn(20, dtype=torch.float32) * 10
+        self.assertEqual(torch.relu(x), x.to_mkldnn().relu().to_dense())
+        self.assertEqual(x.clone().relu_(), x.to_mkldnn().relu_().to_dense())
+
     def test_max_pool2d(self):
         N = torch.randint(3, 10, (1,)).item()
         C = torch.randint(3, 10, (1,)).item()
@@ -353,6 +642,11 @@ class TestMkldnn(TestCase):
         torch.sigmoid_(mkldnn_x)
         self.assertEqual(x, mkldnn_x.to_dense())
 
+    def test_sigmoid_1d(self):
+        x = torch.randn(20, dtype=torch.float32) * 10
+        self.assertEqual(torch.sigmoid(x), x.to_mkldnn().sigmoid().to_dense())
+        self.assertEqual(x.clone().sigmoid_(), x.to_mkldnn().sigmoid_().to_dense())
+
     def _test_serialization(self, module, inputs):
         with TemporaryFileName() as fname:
             torch.jit.save(module, fname)
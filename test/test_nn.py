@@ -8433,6 +8433,34 @@ class TestNN(NNTestCase):
 
         gradcheck(lambda i, w, b, pad: F.conv_tbc(i, w, b, pad), (inp, weight, bias, 3))
 
+    def test_conv2d_row_sparse(self):
+        # double inputs take the THNN path, which skips the output rows whose
+        # receptive field only covers all-zero input rows
+        for stride, padding in [(1, 0), (1, 1), (2, 1)]:
+            x = torch.randn(2, 3, 12, 7, dtype=torch.double)
+            x[0, :, 3:] = 0
+            x[1, :, :9] = 0
+            x.requires_grad_()
+            w = torch.randn(4, 3, 3, 3, dtype=torch.double, requires_grad=True)
+            b = torch.randn(4, dtype=torch.double, requires_grad=True)
+            y = F.conv2d(x, w, b, stride=stride, padding=padding)
+            cols = F.unfold(x, 3, padding=padding, stride=stride)
+            expected = (w.view(4, -1).matmul(cols) + b.view(1, 4, 1)).view_as(y)
+            self.assertEqual(expected, y)
+
+            grad = torch.randn_like(y)
+            self.assertEqual(torch.autograd.grad(expected, (x, w, b), grad),
+                             torch.autograd.grad(y, (x, w, b), grad))
+
+            # without autograd the unfolded input is not expanded back
+            with torch.no_grad():
+                self.assertEqual(expected, F.conv2d(x, w, b, stride=stride, padding=padding))
+
+        x = torch.zeros(1, 2, 5, 5, dtype=torch.double)
+        w = torch.randn(3, 2, 3, 3, dtype=torch.double)
+        b = torch.randn(3, dtype=torch.double)
+        self.assertEqual(F.conv2d(x, w, b), b.view(1, 3, 1, 1).expand(1, 3, 3, 3))
+
     @staticmethod
     def _test_conv_noncontig_weights(self, device):
         for dim in (1, 2, 3):
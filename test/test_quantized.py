@@ -561,6 +561,44 @@ class TestQuantizedConv(unittest.TestCase):
         np.testing.assert_equal(W_q.q_scale(), W_unpacked.q_scale())
         np.testing.assert_equal(W_q.q_zero_point(), W_unpacked.q_zero_point())
 
+    """Tests quantized::fbgemm_conv2d on inputs that are mostly zero point."""
+    def test_qconv_sparse_rows(self):
+        qconv = torch.ops.quantized.fbgemm_conv2d
+        qconv_prepack = torch.ops.quantized.fbgemm_conv_prepack
+
+        # the empty pixels hold the activation zero point, as do the borders
+        # padded by im2col; a zero point of 3 keeps them apart from a literal 0
+        configs = [(X_zero_point, stride, pad) for X_zero_point in [0, 3]
+                   for stride, pad in [(1, 0), (1, 1), (2, 1)]]
+        for X_zero_point, stride, pad in configs:
+            # a few non-empty rows in the middle of the first image only
+            X_init = torch.zeros(2, 8, 16, 12, dtype=torch.int64)
+            X_init[0, :, 6:8, 3:9] = torch.randint(1, 4, (8, 2, 6))
+            W_init = torch.randint(-5, 5, (16, 8, 3, 3))
+            b_init = torch.randint(0, 10, (16,))
+
+            X_scale, W_scale = 1.5, 2.5
+            Y_scale, Y_zero_point = 7.3, 5
+            result_ref = F.conv2d(X_init.float(), W_init.float(), b_init.float(),
+                                  stride, pad)
+
+            X = X_scale * X_init.permute([0, 2, 3, 1]).contiguous().float()
+            W = W_scale * W_init.permute([0, 2, 3, 1]).contiguous().float()
+            b = X_scale * W_scale * b_init.float()
+            X_q = torch.quantize_linear(X, scale=X_scale, zero_point=X_zero_point, dtype=torch.quint8)
+            W_q = torch.quantize_linear(W, scale=W_scale, zero_point=0, dtype=torch.qint8)
+            b_q = torch.quantize_linear(b, scale=X_scale * W_scale, zero_point=0, dtype=torch.qint32)
+            # the second image is all zero point, so its rows are the bias fill
+            np.testing.assert_equal(
+                X_q.int_repr()[1].numpy(), np.full((16, 12, 8), X_zero_point))
+
+            Y_q = qconv(X_q, qconv_prepack(W_q, 1), b_q, [stride, stride], [pad, pad],
+                        [1, 1], 1, Y_scale, Y_zero_point)
+
+            result_q = _requantize(result_ref.permute([0, 2, 3, 1]).numpy(),
+                                   X_scale * W_scale / Y_scale, Y_zero_point)
+            np.testing.assert_equal(result_q, Y_q.int_repr().numpy())
+
 @unittest.skipIf(IS_WINDOWS, "QNNPACK has not been built for Windows")
 @unittest.skipIf(TEST_WITH_UBSAN,
                  "QNNPACK does not play well with UBSAN at the moment,"
@@ -677,6 +677,24 @@ class TestSparse(TestCase):
         test_shape(4, 3, [7, 7, 7, 3, 3, 3, 0])
         test_shape(4, 0, [0, 0, 7, 3, 3, 3, 0])
 
+    def test_coalesce_large(self):
+        # enough nnz for the parallel sort and reduction to split the work
+        nnz = 200000
+        size = [500, 300, 3]
+        i = torch.stack([torch.randint(0, s, (nnz,), device=self.device) for s in size[:2]])
+        v = torch.randn(nnz, size[2], dtype=self.value_dtype, device=self.device)
+        x = self.sparse_tensor(i, v, torch.Size(size))
+        y = x.coalesce()
+        self.assertTrue(y.is_coalesced())
+        flat = y._indices()[0] * size[1] + y._indices()[1]
+        self.assertTrue((flat[1:] > flat[:-1]).all())
+        self.assertEqual(y.to_dense(), x.to_dense())
+
+        # already sorted indices, with duplicates
+        i_sorted = i[:, torch.sort(i[0] * size[1] + i[1])[1]]
+        x = self.sparse_tensor(i_sorted, v, torch.Size(size))
+        self.assertEqual(x.coalesce().to_dense(), x.to_dense())
+
     @cpu_only
     def test_coalesce_transpose_mm(self):
         def test_shape(di, dj, dk, nnz):
@@ -840,6 +858,36 @@ class TestSparse(TestCase):
         test_shape(10, 100, 0, 0)
         test_shape(10, 100, 0, 20)
 
+    def test_mm_large(self):
+        # enough nnz for the parallel kernels to split the work
+        def test_shape(di, dj, dk, nnz):
+            x = self._gen_sparse(2, nnz, [di, dj])[0]
+            t = torch.randn(di, dk, device=self.device)
+            for y in [torch.randn(dj, dk, device=self.device),
+                      torch.randn(dk, dj, device=self.device).t()]:
+                expected = torch.addmm(t, self.safeToDense(x), y, beta=0.5, alpha=2)
+                self.assertEqual(torch.addmm(t, x, y, beta=0.5, alpha=2), expected)
+                self.assertEqual(torch.addmm(t, x.coalesce(), y, beta=0.5, alpha=2), expected)
+
+        test_shape(1000, 500, 64, 20000)
+        # most of the rows empty
+        test_shape(10000, 500, 16, 2000)
+        # few output rows, many products each
+        test_shape(16, 5000, 64, 50000)
+
+    def test_mv(self):
+        def test_shape(di, dj, nnz):
+            x = self._gen_sparse(2, nnz, [di, dj])[0]
+            y = torch.randn(dj, device=self.device)
+            expected = torch.mv(self.safeToDense(x), y)
+            self.assertEqual(torch.mv(x, y), expected)
+            self.assertEqual(x.mv(y), expected)
+            self.assertEqual(torch.matmul(x, y), expected)
+
+        test_shape(10, 100, 20)
+        test_shape(1000, 500, 20000)
+        test_shape(10, 100, 0)
+
     @cpu_only
     def test_saddmm(self):
         def test_shape(di, dj, dk, nnz):
@@ -995,6 +1043,33 @@ class TestSparse(TestCase):
         self._test_spadd_shape(0, [50, 0, 20])
         self._test_spadd_shape(0, [50, 30, 0])
 
+    def test_add_coalesced_large(self):
+        # enough nnz for the merge of coalesced operands to be split
+        def gen(size, nnz, dense_size):
+            i = torch.stack([torch.randint(0, s, (nnz,), device=self.device) for s in size])
+            v = torch.randn(nnz, *dense_size, dtype=self.value_dtype, device=self.device)
+            return self.sparse_tensor(i, v, torch.Size(size + dense_size)).coalesce()
+
+        def test_shape(size, nnz, dense_size=[]):
+            x = gen(size, nnz, dense_size)
+            y = gen(size, nnz, dense_size)
+            # share some of the indices
+            z = self.sparse_tensor(x._indices()[:, ::3], x._values()[::3] + 1, x.size()).coalesce()
+            for a, b in [(x, y), (x, z), (z, x)]:
+                expected = a.to_dense() + 2 * b.to_dense()
+                res = torch.add(a, 2, b)
+                self.assertTrue(res.is_coalesced())
+                self.assertEqual(res.to_dense(), expected)
+                res = res.coalesce()
+                flat = res._indices()[0] * size[1] + res._indices()[1]
+                self.assertTrue((flat[1:] > flat[:-1]).all())
+                a_copy = a.clone()
+                a_copy.add_(2, b)
+                self.assertEqual(a_copy.to_dense(), expected)
+
+        test_shape([1000, 1000], 100000)
+        test_shape([300, 300], 20000, [4])
+
     def test_spadd_hybrid(self):
         self._test_spadd_shape(10, [5, 6], [2, 3])
         self._test_spadd_shape(10, [10, 10, 10], [3])
@@ -1382,6 +1457,41 @@ class TestSparse(TestCase):
 
         self.assertRaises(RuntimeError, lambda: with_dense.narrow_copy(10, 0, 3))  # dim > sparseDim + denseDim
 
+    def test_zero_preserving_unary_ops(self):
+        ops = [torch.abs, torch.asin, torch.atan, torch.ceil, torch.erf, torch.erfinv,
+               torch.expm1, torch.floor, torch.frac, torch.neg, torch.round, torch.sign,
+               torch.sin, torch.sinh, torch.tan, torch.tanh, torch.trunc, torch.relu,
+               lambda x: torch.clamp(x, -0.05, 0.05), lambda x: torch.clamp(x, min=-0.05),
+               lambda x: torch.sqrt(torch.abs(x))]
+        inplace_ops = [torch.Tensor.abs_, torch.Tensor.erf_, torch.Tensor.erfinv_,
+                       torch.Tensor.neg_, torch.Tensor.sign_, torch.Tensor.trunc_, torch.relu_,
+                       lambda x: x.clamp_(-0.05, 0.05)]
+
+        for sparse_dims, nnz, with_size in [(2, 10, [5, 6]), (2, 10, [5, 6, 2]), (1, 0, [5])]:
+            x = self._gen_sparse(sparse_dims, nnz, with_size)[0]
+            # keep the values in the domain of asin
+            x = self.sparse_tensor(x._indices(), (torch.rand_like(x._values()) - 0.5) / 4, x.size())
+            x_dense = self.safeToDense(x)
+            for op in ops:
+                res = op(x)
+                self.assertTrue(res.is_sparse)
+                self.assertTrue(res.is_coalesced())
+                self.assertEqual(res.to_dense(), op(x_dense))
+
+            for op in inplace_ops:
+                y = x.coalesce().clone()
+                op(y)
+                self.assertTrue(y.is_sparse)
+                self.assertEqual(y.to_dense(), op(x_dense.clone()))
+
+        x = self._gen_sparse(2, 10, [5, 6])[0]
+        with self.assertRaisesRegex(RuntimeError, "clamp: the range must contain zero"):
+            torch.clamp(x, min=0.5)
+
+        if self.is_uncoalesced:
+            with self.assertRaisesRegex(RuntimeError, "in-place on uncoalesced tensors is not supported yet"):
+                x.abs_()
+
     def _test_log1p_tensor(self, input, dense_tensor):
         expected_output = dense_tensor.log1p()
         self.assertEqual(expected_output, input.log1p().to_dense())
@@ -486,8 +486,14 @@ Kernel = namedtuple('Kernel', ['name', 'device', 'interval'])
 
 # TODO: record TID too
 class FunctionEvent(FormattedTimesMixin):
-    """Profiling information about a single function."""
-    def __init__(self, id, name, thread, cpu_start, cpu_end, input_shapes=None):
+    """Profiling information about a single function.
+
+    ``counters`` holds extra per-op statistics keyed by name, e.g. the rows
+    visited and skipped by the sparse MKL-DNN convolution, its occupancy scan
+    and kernel times in us and the load imbalance between its threads.
+    """
+    def __init__(self, id, name, thread, cpu_start, cpu_end, input_shapes=None,
+                 counters=None):
         self.id = id
         self.name = name
         self.cpu_interval = Interval(cpu_start, cpu_end)
@@ -496,6 +502,7 @@ class FunctionEvent(FormattedTimesMixin):
         self.count = 1
         self.cpu_children = []
         self.input_shapes = input_shapes
+        self.counters = counters or {}
 
     def append_kernel(self, name, device, start, end):
         self.kernels.append(Kernel(name, device, Interval(start, end)))
@@ -638,7 +645,8 @@ def parse_cpu_trace(thread_records):
                 thread=start.thread_id(),
                 cpu_start=start_record.cpu_elapsed_us(start),
                 cpu_end=start_record.cpu_elapsed_us(record),
-                input_shapes=start.shapes())
+                input_shapes=start.shapes(),
+                counters=dict(record.counters()))
             if start.has_cuda():
                 cuda_start = adjusted_time(start)
                 cuda_end = adjusted_time(record)
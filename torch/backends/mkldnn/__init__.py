@@ -1,6 +1,71 @@
+import sys
 import torch
+import types
+from contextlib import contextmanager
+
+# Write:
+#
+#   torch.backends.mkldnn.sparse_conv = True
+#
+# to let convolutions dispatch to the sparse MKL-DNN convolution, which skips
+# all-zero input rows, whenever the sampled fraction of non-zero input rows is
+# below torch.backends.mkldnn.sparse_conv_threshold. Single layers can opt in
+# unconditionally with torch.mkldnn_convolution_sparse instead, which also
+# accepts a precomputed row mask.
 
 
 def is_available():
     r"""Returns whether PyTorch is built with MKL-DNN support."""
     return torch._C.has_mkldnn
+
+
+def is_sparse_conv_available():
+    r"""Returns whether the linked MKL-DNN can skip all-zero input rows."""
+    return torch._mkldnn_sparse_conv_available()
+
+
+def set_flags(_sparse_conv, _sparse_conv_threshold):
+    orig_flags = (torch._C._get_mkldnn_sparse_conv(),
+                  torch._C._get_mkldnn_sparse_conv_threshold())
+    torch._C._set_mkldnn_sparse_conv(_sparse_conv)
+    torch._C._set_mkldnn_sparse_conv_threshold(_sparse_conv_threshold)
+    return orig_flags
+
+
+@contextmanager
+def flags(sparse_conv=False, sparse_conv_threshold=0.5):
+    orig_flags = set_flags(sparse_conv, sparse_conv_threshold)
+    try:
+        yield
+    finally:
+        # recover the previous values
+        set_flags(orig_flags[0], orig_flags[1])
+
+
+class ContextProp(object):
+    def __init__(self, getter, setter):
+        self.getter = getter
+        self.setter = setter
+
+    def __get__(self, obj, objtype):
+        return self.getter()
+
+    def __set__(self, obj, val):
+        self.setter(val)
+
+
+class MkldnnModule(types.ModuleType):
+    def __init__(self, m, name):
+        super(MkldnnModule, self).__init__(name)
+        self.m = m
+
+    def __getattr__(self, attr):
+        return self.m.__getattribute__(attr)
+
+    sparse_conv = ContextProp(torch._C._get_mkldnn_sparse_conv, torch._C._set_mkldnn_sparse_conv)
+    sparse_conv_threshold = ContextProp(torch._C._get_mkldnn_sparse_conv_threshold,
+                                        torch._C._set_mkldnn_sparse_conv_threshold)
+
+# This is the sys.modules replacement trick, see
+# https://stackoverflow.com/questions/2447353/getattr-on-a-module/7668273#7668273
+sys.modules[__name__] = MkldnnModule(sys.modules[__name__], __name__)
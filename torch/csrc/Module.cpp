@@ -443,6 +443,33 @@ PyObject *THPModule_benchmarkCuDNN(PyObject *_unused)
   else Py_RETURN_FALSE;
 }
 
+PyObject *THPModule_setSparseConvMkldnn(PyObject *_unused, PyObject *arg)
+{
+  THPUtils_assert(PyBool_Check(arg), "set_sparse_conv_mkldnn expects a bool, "
+          "but got %s", THPUtils_typename(arg));
+  at::globalContext().setSparseConvMkldnn(arg == Py_True);
+  Py_RETURN_NONE;
+}
+
+PyObject *THPModule_sparseConvMkldnn(PyObject *_unused)
+{
+  if (at::globalContext().sparseConvMkldnn()) Py_RETURN_TRUE;
+  else Py_RETURN_FALSE;
+}
+
+PyObject *THPModule_setSparseConvMkldnnThreshold(PyObject *_unused, PyObject *arg)
+{
+  THPUtils_assert(THPUtils_checkDouble(arg), "set_sparse_conv_mkldnn_threshold "
+          "expects a float, but got %s", THPUtils_typename(arg));
+  at::globalContext().setSparseConvMkldnnThreshold(THPUtils_unpackDouble(arg));
+  Py_RETURN_NONE;
+}
+
+PyObject *THPModule_sparseConvMkldnnThreshold(PyObject *_unused)
+{
+  return PyFloat_FromDouble(at::globalContext().sparseConvMkldnnThreshold());
+}
+
 PyObject *THPModule_setFlushDenormal(PyObject *_unused, PyObject *arg) {
   THPUtils_assert(PyBool_Check(arg), "flush_denormal expects a bool, "
           "but got %s", THPUtils_typename(arg));
@@ -498,6 +525,10 @@ static PyMethodDef TorchMethods[] = {
   {"_set_cudnn_benchmark", (PyCFunction)THPModule_setBenchmarkCuDNN, METH_O,  nullptr},
   {"_get_cudnn_deterministic", (PyCFunction)THPModule_deterministicCuDNN, METH_NOARGS,     nullptr},
   {"_set_cudnn_deterministic", (PyCFunction)THPModule_setDeterministicCuDNN, METH_O,  nullptr},
+  {"_get_mkldnn_sparse_conv", (PyCFunction)THPModule_sparseConvMkldnn, METH_NOARGS,     nullptr},
+  {"_set_mkldnn_sparse_conv", (PyCFunction)THPModule_setSparseConvMkldnn, METH_O,  nullptr},
+  {"_get_mkldnn_sparse_conv_threshold", (PyCFunction)THPModule_sparseConvMkldnnThreshold, METH_NOARGS,     nullptr},
+  {"_set_mkldnn_sparse_conv_threshold", (PyCFunction)THPModule_setSparseConvMkldnnThreshold, METH_O,  nullptr},
   {"_to_dlpack",      (PyCFunction)THPModule_toDLPack,          METH_O,       nullptr},
   {"_from_dlpack",    (PyCFunction)THPModule_fromDLPack,        METH_O,       nullptr},
   {"set_flush_denormal", (PyCFunction)THPModule_setFlushDenormal, METH_O,     nullptr},
@@ -1,5 +1,6 @@
 #include <torch/csrc/autograd/profiler.h>
 #include <torch/csrc/jit/code_template.h>
+#include <ATen/SparseConvStats.h>
 
 #include <fstream>
 #include <list>
@@ -62,6 +63,8 @@ void pushRangeImpl(
   if (state == ProfilerState::Disabled) {
     return;
   }
+  // counters from before the range belong to no op
+  at::take_sparse_conv_stats();
   if (state == ProfilerState::NVTX) {
     if(sequence_nr >= 0 || shapes.size() > 0) {
       std::stringstream s;
@@ -111,11 +114,17 @@ void popRange() {
   if (state == ProfilerState::NVTX) {
     cuda_stubs->nvtxRangePop();
   } else {
-    getEventList().record(
+    auto& list = getEventList();
+    list.record(
         EventKind::PopRange,
         StringView(""),
         thread_id,
         state == ProfilerState::CUDA);
+    // the innermost op that ran sparse convolutions reports their counters
+    if (at::sparse_conv_stats().calls > 0) {
+      list.blocks.front().back().set_counters(
+          at::take_sparse_conv_stats().counters());
+    }
   }
 }
 
@@ -9,6 +9,7 @@
 #include <sstream>
 #include <forward_list>
 #include <tuple>
+#include <utility>
 #include <ATen/ATen.h>
 #include <torch/csrc/WindowsTorchApiMacro.h>
 #ifndef _WIN32
@@ -150,6 +151,14 @@ struct TORCH_API Event final {
   std::vector<std::vector<int64_t>> shapes() const {
     return shapes_;
   }
+  // Extra per-op counters, e.g. at::SparseConvStats, reported on the
+  // PopRange event of the op that ran them
+  const std::vector<std::pair<std::string, double>>& counters() const {
+    return counters_;
+  }
+  void set_counters(std::vector<std::pair<std::string, double>>&& counters) {
+    counters_ = std::move(counters);
+  }
   double cpu_elapsed_us(const Event & e) {
     return (e.cpu_ns_ - cpu_ns_)/(1000.0);
   }
@@ -167,6 +176,7 @@ private:
   EventKind kind_;
   uint16_t thread_id_;
   std::vector<std::vector<int64_t>> shapes_;
+  std::vector<std::pair<std::string, double>> counters_;
   int device_ = -1;
   struct CUevent_st* event = nullptr;
 };
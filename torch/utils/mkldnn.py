@@ -34,17 +34,24 @@ class MkldnnLinear(torch.jit.ScriptModule):
 
 
 class MkldnnConv2d(torch.jit.ScriptModule):
-    __constants__ = ['stride', 'padding', 'dilation', 'groups']
+    __constants__ = ['stride', 'padding', 'dilation', 'groups', 'fuse_relu']
 
-    def __init__(self, dense_module):
+    def __init__(self, dense_module, fuse_relu=False):
         super(MkldnnConv2d, self).__init__()
 
         self.stride = dense_module.stride
         self.padding = dense_module.padding
         self.dilation = dense_module.dilation
         self.groups = dense_module.groups
+        self.fuse_relu = fuse_relu
 
-        self.register_buffer('weight', dense_module.weight.to_mkldnn())
+        # reordered once here, instead of on every forward call
+        self.register_buffer('weight', torch._C._nn.mkldnn_reorder_conv2d_weight(
+            dense_module.weight.to_mkldnn(),
+            self.padding,
+            self.stride,
+            self.dilation,
+            self.groups))
         if dense_module.bias is not None:
             self.register_buffer('bias', dense_module.bias.to_mkldnn())
         else:
@@ -70,6 +77,15 @@ class MkldnnConv2d(torch.jit.ScriptModule):
 
     @torch.jit.script_method
     def forward(self, x):
+        if self.fuse_relu:
+            return torch.mkldnn_convolution_relu(
+                x,
+                self.weight,
+                self.bias,
+                self.padding,
+                self.stride,
+                self.dilation,
+                self.groups)
         return torch.conv2d(
             x,
             self.weight,
@@ -145,8 +161,21 @@ def to_mkldnn(module):
 
     def m_fn_rec(m):
         new_m = m_fn(m)
-        for name, sub_m in m.named_children():
-            setattr(new_m, name, m_fn_rec(sub_m))
+        children = list(m.named_children())
+        fused = set()
+        for i, (name, sub_m) in enumerate(children):
+            if name in fused:
+                continue
+            # A ReLU right after a Conv2d in a Sequential becomes a post-op of
+            # the convolution, which saves a pass over the activation
+            if isinstance(m, torch.nn.Sequential) and isinstance(sub_m, torch.nn.Conv2d) and \
+                    i + 1 < len(children) and isinstance(children[i + 1][1], torch.nn.ReLU):
+                relu_name = children[i + 1][0]
+                setattr(new_m, name, MkldnnConv2d(sub_m, fuse_relu=True))
+                setattr(new_m, relu_name, torch.nn.Identity())
+                fused.add(relu_name)
+            else:
+                setattr(new_m, name, m_fn_rec(sub_m))
         return new_m
 
     return m_fn_rec(module)